@@ -0,0 +1,228 @@
+// Offline benchmark of the native pipeline stages, fed from a FrameRecorder capture
+// Usage: KinectBenchmark <capture> [passes]
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cwchar>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "KinectWrapper.h"
+
+// Every heap allocation in the process, stages are expected not to add any
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(const size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (const auto memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Timings of one stage, one sample per call
+class Stage
+{
+    const char* name_;
+    std::vector<int64_t> samples_;
+    uint64_t allocations_ = 0;
+
+public:
+    Stage(const char* name, const size_t capacity) : name_(name)
+    {
+        samples_.reserve(capacity);
+    }
+
+    template <typename Body>
+    void run(Body&& body)
+    {
+        const auto before = allocations.load(std::memory_order_relaxed);
+        const auto start = qpc_now();
+        body();
+        const auto elapsed = qpc_now() - start;
+
+        allocations_ += allocations.load(std::memory_order_relaxed) - before;
+        samples_.push_back(elapsed);
+    }
+
+    void report()
+    {
+        if (samples_.empty()) return;
+        std::sort(samples_.begin(), samples_.end());
+
+        int64_t total = 0;
+        for (const auto sample : samples_) total += sample;
+
+        const auto count = samples_.size();
+        const auto percentile = [&](const double p)
+        {
+            return qpc_to_seconds(samples_[std::min(count - 1, static_cast<size_t>(p * count))]) * 1e6;
+        };
+
+        std::printf("%-20s %8zu %12.0f %9.2f %9.2f %9.2f %9.2f %8.2f\n", name_, count,
+                    count / std::max(qpc_to_seconds(total), 1e-9), percentile(0.5), percentile(0.9),
+                    percentile(0.99), qpc_to_seconds(samples_.back()) * 1e6,
+                    static_cast<double>(allocations_) / count);
+    }
+};
+
+// What the managed side copies out of a snapshot, without the managed types
+struct ExportedJoint
+{
+    float position[3];
+    float orientation[4];
+    int tracking_state;
+};
+
+// Sinks results where the optimizer can't see through them
+static volatile float checksum = 0;
+
+int wmain(const int argc, wchar_t* argv[])
+{
+    if (argc < 2)
+    {
+        std::fwprintf(stderr, L"Usage: %ls <capture> [passes]\n", argv[0]);
+        return 1;
+    }
+
+    const auto passes = argc > 2 ? std::max(static_cast<int>(std::wcstol(argv[2], nullptr, 10)), 1) : 10;
+
+    FrameReplay replay;
+    if (!replay.open(argv[1]))
+    {
+        std::fwprintf(stderr, L"Couldn't open %ls (or its .idx)\n", argv[1]);
+        return 1;
+    }
+
+    // Unpack everything up front, so the stages only see memory they'd see live
+    std::vector<BodyFrame> frames;
+    std::vector<TIMESPAN> timestamps;
+    size_t colorRecords = 0;
+    for (auto entry = replay.peek(); entry; replay.advance(), entry = replay.peek())
+    {
+        if (entry->type == recording::RecordType::Color) colorRecords++;
+        if (entry->type != recording::RecordType::Body) continue;
+
+        frames.emplace_back();
+        if (!replay.read_bodies(*entry, frames.back())) frames.pop_back();
+        else timestamps.push_back(entry->timestamp);
+    }
+
+    if (frames.empty())
+    {
+        std::fwprintf(stderr, L"%ls has no body frames\n", argv[1]);
+        return 1;
+    }
+
+    const auto bodySamples = frames.size() * passes;
+    Stage publishFrame("body frame publish", bodySamples), select("body selection", bodySamples),
+          publishSnapshot("snapshot publish", bodySamples), readSnapshot("snapshot read", bodySamples),
+          exportJoints("joint export", bodySamples), oneEuro("filter one euro", bodySamples),
+          holt("filter holt", bodySamples), predict("prediction", bodySamples),
+          gestures("gestures", bodySamples);
+
+    auto bodyFrame = std::make_unique<SeqLocked<BodyFrame>>();
+    SeqLocked<SkeletonSnapshot> skeleton;
+    BodySelector selector;
+    JointFilterBank oneEuroBank, holtBank;
+    JointPredictor predictor;
+    GestureStage gestureStage;
+
+    JointFilterSettings oneEuroSettings, holtSettings;
+    oneEuroSettings.type = JointFilterType::OneEuro;
+    holtSettings.type = JointFilterType::DoubleExponential;
+
+    SkeletonSnapshot snapshot, filtered;
+    std::array<ExportedJoint, JointType_Count> exported{}; // Amethyst order, the first JointManual used
+    uint64_t sequence = 0;
+
+    // Timestamps keep growing across passes, or the filters would reset on every wrap
+    const auto captureLength = timestamps.back() - timestamps.front() + 333333;
+
+    for (auto pass = 0; pass < passes; pass++)
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            auto& frame = frames[i];
+            const auto timestamp = timestamps[i] + pass * captureLength;
+            frame.sequence = ++sequence;
+
+            publishFrame.run([&] { bodyFrame->store(frame); });
+
+            auto index = -1;
+            select.run([&] { index = selector.select(frame, BodySelection::LockFirst, 0); });
+
+            snapshot = index >= 0 ? frame.bodies[index] : SkeletonSnapshot{};
+            snapshot.timestamp = timestamp;
+            snapshot.sequence = sequence;
+
+            publishSnapshot.run([&] { skeleton.store(snapshot); });
+            readSnapshot.run([&] { snapshot = skeleton.load(); });
+
+            exportJoints.run([&]
+            {
+                const auto& positions = KinectWrapper::gather_joints(snapshot.joints);
+                const auto& orientations = KinectWrapper::gather_joints(snapshot.orientations);
+                for (size_t j = 0; j < positions.size(); j++)
+                {
+                    const auto& position = positions[j].Position;
+                    const auto& orientation = orientations[j].Orientation;
+                    exported[j] = {
+                        {position.X, position.Y, position.Z},
+                        {orientation.x, orientation.y, orientation.z, orientation.w},
+                        positions[j].TrackingState
+                    };
+                }
+            });
+
+            oneEuro.run([&] { oneEuroBank.apply(snapshot, filtered, oneEuroSettings); });
+            holt.run([&] { holtBank.apply(snapshot, filtered, holtSettings); });
+            predict.run([&] { checksum = predictor.push(filtered).angular_velocity[0].X; });
+            gestures.run([&] { checksum = static_cast<float>(gestureStage.push(filtered).active); });
+
+            checksum = exported[0].position[0] + filtered.joints[0].Position.X;
+        }
+
+    // Captures keep only downscaled previews, so color runs on a full-size synthetic YUY2 frame
+    constexpr auto Width = 1920, Height = 1080;
+    const auto colorSamples = std::max<size_t>(colorRecords, 300) * passes;
+    Stage convert("yuy2 to bgra", colorSamples), half("downscale 1/2", colorSamples),
+          quarter("downscale 1/4", colorSamples);
+
+    std::vector<BYTE> yuy2(Width * Height * 2), bgra(Width * Height * 4),
+                      scaled(Width * Height), scratch(Width * Height);
+    for (size_t i = 0; i < yuy2.size(); i++)
+        yuy2[i] = static_cast<BYTE>(i % 2 ? 128 + (i / 4) % 64 : (i / 2) % 251);
+
+    for (size_t i = 0; i < colorSamples; i++)
+    {
+        convert.run([&] { convert_yuy2_to_bgra(yuy2.data(), Width, Height, bgra.data()); });
+        half.run([&] { scale_bgra(bgra.data(), Width, Height, Width * 4, 2, scaled.data(), nullptr); });
+        quarter.run([&] { scale_bgra(bgra.data(), Width, Height, Width * 4, 4, scaled.data(), scratch.data()); });
+        checksum = scaled[i % scaled.size()];
+    }
+
+    std::printf("%zu body frames, %zu color records, %d passes\n\n", frames.size(), colorRecords, passes);
+    std::printf("%-20s %8s %12s %9s %9s %9s %9s %8s\n",
+                "stage", "samples", "per second", "p50 us", "p90 us", "p99 us", "max us", "allocs");
+
+    for (const auto stage : {&publishFrame, &select, &publishSnapshot, &readSnapshot, &exportJoints,
+                             &oneEuro, &holt, &predict, &gestures, &convert, &half, &quarter})
+        stage->report();
+
+    return 0;
+}
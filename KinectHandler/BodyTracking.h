@@ -0,0 +1,78 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <array>
+#include <cstdint>
+
+#include "SkeletonSnapshot.h"
+
+enum class BodySelection
+{
+    LockFirst, // Keep the first tracked user until they leave
+    Closest, // Follow whoever's nearest to the sensor
+    Manual // Follow a chosen TrackingId (falls back to LockFirst)
+};
+
+// Every tracked body of one frame, packed at the front
+struct BodyFrame
+{
+    std::array<SkeletonSnapshot, BODY_COUNT> bodies{};
+    size_t count = 0;
+    uint64_t sequence = 0; // Same as the published skeleton's
+};
+
+// Picks the tracked user out of a BodyFrame, sticking to them between frames
+class BodySelector
+{
+    static constexpr float SwitchMargin = 0.15f; // m, Closest won't flip on noise
+
+    UINT64 locked_id_ = 0;
+
+    static int find(const BodyFrame& frame, const UINT64 trackingId)
+    {
+        if (trackingId == 0) return -1;
+        for (size_t i = 0; i < frame.count; i++)
+            if (frame.bodies[i].tracking_id == trackingId) return static_cast<int>(i);
+
+        return -1;
+    }
+
+    static float distance(const SkeletonSnapshot& body)
+    {
+        return body.joints[JointType_SpineBase].Position.Z;
+    }
+
+public:
+    void reset()
+    {
+        locked_id_ = 0;
+    }
+
+    UINT64 locked_id() const
+    {
+        return locked_id_;
+    }
+
+    // Index of the body to follow, -1 if there's nobody
+    int select(const BodyFrame& frame, const BodySelection policy, const UINT64 manualId)
+    {
+        if (frame.count == 0)
+        {
+            locked_id_ = 0;
+            return -1;
+        }
+
+        auto index = policy == BodySelection::Manual ? find(frame, manualId) : -1;
+        if (index < 0) index = find(frame, locked_id_);
+
+        if (policy == BodySelection::Closest)
+            for (size_t i = 0; i < frame.count; i++)
+                if (index < 0 || distance(frame.bodies[i]) + SwitchMargin < distance(frame.bodies[index]))
+                    index = static_cast<int>(i);
+
+        if (index < 0) index = 0; // The previous user left, take the first one
+        locked_id_ = frame.bodies[index].tracking_id;
+        return index;
+    }
+};
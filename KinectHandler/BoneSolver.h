@@ -0,0 +1,132 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "SkeletonSnapshot.h"
+
+// Learns the followed user's bone lengths from tracked joints, then holds inferred joints to them
+// One fixed pass from the spine outwards, no allocations, a few hundred flops per frame
+class BoneSolver
+{
+    // Knees and elbows, which can't fold past MinHingeAngle: (upper, middle, lower) joints
+    static constexpr std::array<std::array<JointType, 3>, 4> Hinges
+    {
+        {
+            {JointType_HipLeft, JointType_KneeLeft, JointType_AnkleLeft},
+            {JointType_HipRight, JointType_KneeRight, JointType_AnkleRight},
+            {JointType_ShoulderLeft, JointType_ElbowLeft, JointType_WristLeft},
+            {JointType_ShoulderRight, JointType_ElbowRight, JointType_WristRight}
+        }
+    };
+
+    static constexpr float LearningRate = 0.05f; // Per tracked frame, ~1s to settle
+    static constexpr uint32_t MinSamples = 30; // Don't enforce a length seen only briefly
+    static constexpr float MinBone = 0.02f, MaxBone = 0.8f; // m, anything else is a bad measurement
+    static constexpr float MinHingeAngle = 0.52f; // rad, ~30 degrees between the two segments
+
+    std::array<float, SkeletonBones.size()> lengths_{};
+    std::array<uint32_t, SkeletonBones.size()> samples_{};
+    UINT64 user_ = 0; // Whose lengths these are
+
+    static CameraSpacePoint sub(const CameraSpacePoint& a, const CameraSpacePoint& b)
+    {
+        return {a.X - b.X, a.Y - b.Y, a.Z - b.Z};
+    }
+
+    static CameraSpacePoint add_scaled(const CameraSpacePoint& a, const CameraSpacePoint& b, const float scale)
+    {
+        return {a.X + b.X * scale, a.Y + b.Y * scale, a.Z + b.Z * scale};
+    }
+
+    static float dot(const CameraSpacePoint& a, const CameraSpacePoint& b)
+    {
+        return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+    }
+
+    static bool tracked(const Joint& joint)
+    {
+        return joint.TrackingState == TrackingState_Tracked;
+    }
+
+    static bool inferred(const Joint& joint)
+    {
+        return joint.TrackingState == TrackingState_Inferred;
+    }
+
+    // Keeps the lower segment at least MinHingeAngle open from the upper one, in their plane
+    // Only an inferred lower joint is moved, tracked ones are the sensor's to keep
+    static void clamp_hinge(std::array<Joint, JointType_Count>& joints, const std::array<JointType, 3>& hinge)
+    {
+        auto& lower = joints[hinge[2]];
+        if (!inferred(lower) || joints[hinge[0]].TrackingState == TrackingState_NotTracked ||
+            joints[hinge[1]].TrackingState == TrackingState_NotTracked) return;
+
+        const auto& middle = joints[hinge[1]].Position;
+        const auto up = sub(joints[hinge[0]].Position, middle);
+        const auto down = sub(lower.Position, middle);
+
+        const auto upLength = std::sqrt(dot(up, up)), downLength = std::sqrt(dot(down, down));
+        if (upLength < 1e-4f || downLength < 1e-4f) return;
+
+        const auto u = add_scaled({}, up, 1.0f / upLength);
+        if (dot(u, down) / downLength <= std::cos(MinHingeAngle)) return; // Open enough
+
+        // Rotate the lower segment away from the upper one, keeping its length
+        const auto across = add_scaled(down, u, -dot(u, down));
+        const auto acrossLength = std::sqrt(dot(across, across));
+        if (acrossLength < 1e-4f) return; // Folded exactly onto itself, no plane to rotate in
+
+        const auto direction = add_scaled(add_scaled({}, u, std::cos(MinHingeAngle)),
+                                          across, std::sin(MinHingeAngle) / acrossLength);
+        lower.Position = add_scaled(middle, direction, downLength);
+    }
+
+public:
+    void reset()
+    {
+        lengths_.fill(0);
+        samples_.fill(0);
+        user_ = 0;
+    }
+
+    // Learn from this frame's tracked bones, then fix up the inferred ones
+    void solve(SkeletonSnapshot& snapshot)
+    {
+        // Someone else's skeleton starts from scratch, even after nobody was tracked in between
+        if (snapshot.tracking_id != user_)
+        {
+            reset();
+            user_ = snapshot.tracking_id;
+        }
+
+        auto& joints = snapshot.joints;
+        for (size_t i = 0; i < SkeletonBones.size(); i++)
+        {
+            const auto& parent = joints[SkeletonBones[i].parent];
+            auto& child = joints[SkeletonBones[i].child];
+            const auto bone = sub(child.Position, parent.Position);
+            const auto length = std::sqrt(dot(bone, bone));
+
+            if (tracked(parent) && tracked(child))
+            {
+                if (length < MinBone || length > MaxBone) continue;
+                lengths_[i] = samples_[i] ? lengths_[i] + LearningRate * (length - lengths_[i]) : length;
+                samples_[i]++;
+                continue;
+            }
+
+            // Inferred: keep the direction the sensor guessed, at the learned length
+            // (The parent may have been moved already, inferred children follow it; tracked ones stay put)
+            if (!inferred(child) || samples_[i] < MinSamples || length < 1e-4f)
+                continue;
+
+            child.Position = add_scaled(parent.Position, bone, lengths_[i] / length);
+        }
+
+        for (const auto& hinge : Hinges) clamp_hinge(joints, hinge);
+    }
+};
@@ -0,0 +1,160 @@
+#pragma once
+#include <Windows.h>
+
+#include <cstdint>
+#include <cstring>
+#include <emmintrin.h>
+
+// Full-range BT.601 YUY2 -> BGRA for one pixel, used for leftovers
+inline void convert_yuv_pixel(const int y, const int u, const int v, BYTE* out)
+{
+    const auto clamp = [](const int value) { return static_cast<BYTE>(value < 0 ? 0 : value > 255 ? 255 : value); };
+    out[0] = clamp(y + ((u * 14516) >> 13));
+    out[1] = clamp(y - ((u * 2818 + v * 5849) >> 13));
+    out[2] = clamp(y + ((v * 11485) >> 13));
+    out[3] = 0xFF;
+}
+
+// Converts packed YUY2 (Y0 U Y1 V) to BGRA, 8 pixels per SSE2 step
+inline void convert_yuy2_to_bgra(const BYTE* source, const int width, const int height, BYTE* destination)
+{
+    const auto count = static_cast<size_t>(width) * height;
+    const auto zero = _mm_setzero_si128();
+    const auto lowMask = _mm_set1_epi16(0x00FF);
+    const auto bias = _mm_set1_epi16(128);
+    const auto alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+
+    // Chroma coefficients in 1/8192ths, applied to (chroma << 3) with mulhi
+    const auto coeffUb = _mm_set1_epi16(14516), coeffUg = _mm_set1_epi16(2818);
+    const auto coeffVg = _mm_set1_epi16(5849), coeffVr = _mm_set1_epi16(11485);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const auto packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2));
+
+        // Y0..Y7 and U0 V0 U1 V1.. as 16-bit lanes
+        const auto luma = _mm_and_si128(packed, lowMask);
+        const auto chroma = _mm_slli_epi16(_mm_sub_epi16(_mm_srli_epi16(packed, 8), bias), 3);
+
+        // Each U/V pair covers two pixels, spread them out
+        const auto u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(chroma, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+        const auto v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(chroma, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+
+        const auto b = _mm_add_epi16(luma, _mm_mulhi_epi16(u, coeffUb));
+        const auto g = _mm_sub_epi16(luma, _mm_add_epi16(_mm_mulhi_epi16(u, coeffUg), _mm_mulhi_epi16(v, coeffVg)));
+        const auto r = _mm_add_epi16(luma, _mm_mulhi_epi16(v, coeffVr));
+
+        // Saturate and interleave into B G R A
+        const auto bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, zero), _mm_packus_epi16(g, zero));
+        const auto ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, zero), alpha);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4 + 16), _mm_unpackhi_epi16(bg, ra));
+    }
+
+    // Leftovers, two pixels at a time
+    for (; i + 2 <= count; i += 2)
+    {
+        const auto pair = source + i * 2;
+        convert_yuv_pixel(pair[0], pair[1] - 128, pair[3] - 128, destination + i * 4);
+        convert_yuv_pixel(pair[2], pair[1] - 128, pair[3] - 128, destination + i * 4 + 4);
+    }
+}
+
+// Copies a BGRA region row by row (no scaling)
+inline void copy_bgra(const BYTE* source, const int width, const int height, const size_t sourceStride,
+                      BYTE* destination, const size_t destinationStride)
+{
+    for (int y = 0; y < height; y++)
+        std::memcpy(destination + y * destinationStride, source + y * sourceStride, width * 4);
+}
+
+// Halves a BGRA image with a 2x2 box filter, 4 output pixels per SSE2 step
+inline void downscale_bgra_half(const BYTE* source, const int width, const int height, const size_t sourceStride,
+                                BYTE* destination, const size_t destinationStride)
+{
+    const auto outWidth = width / 2, outHeight = height / 2;
+    for (int y = 0; y < outHeight; y++)
+    {
+        const auto row0 = source + 2 * y * sourceStride;
+        const auto row1 = row0 + sourceStride;
+        const auto out = destination + y * destinationStride;
+
+        auto x = 0;
+        for (; x + 4 <= outWidth; x += 4)
+        {
+            // 8 pixels from both rows, averaged vertically
+            const auto top0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+            const auto top1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16));
+            const auto bottom0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+            const auto bottom1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 16));
+
+            const auto vertical0 = _mm_castsi128_ps(_mm_avg_epu8(top0, bottom0));
+            const auto vertical1 = _mm_castsi128_ps(_mm_avg_epu8(top1, bottom1));
+
+            // Pixels are 32-bit, so split even/odd ones and average those horizontally
+            const auto even = _mm_castps_si128(_mm_shuffle_ps(vertical0, vertical1, _MM_SHUFFLE(2, 0, 2, 0)));
+            const auto odd = _mm_castps_si128(_mm_shuffle_ps(vertical0, vertical1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_avg_epu8(even, odd));
+        }
+
+        // Leftovers, if the width isn't a multiple of 8
+        for (; x < outWidth; x++)
+            for (auto c = 0; c < 4; c++)
+                out[x * 4 + c] = static_cast<BYTE>(
+                    (row0[x * 8 + c] + row0[x * 8 + 4 + c] +
+                        row1[x * 8 + c] + row1[x * 8 + 4 + c] + 2) / 4);
+    }
+}
+
+// Doubles a tightly packed BGRA image in both directions (nearest), 4 source pixels per SSE2 step
+inline void upscale_bgra_double(const BYTE* source, const int width, const int height, BYTE* destination)
+{
+    const auto destinationStride = static_cast<size_t>(width) * 8;
+    for (int y = 0; y < height; y++)
+    {
+        const auto in = source + static_cast<size_t>(y) * width * 4;
+        const auto out = destination + y * 2 * destinationStride;
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            const auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 8), _mm_unpacklo_epi32(pixels, pixels));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 8 + 16), _mm_unpackhi_epi32(pixels, pixels));
+        }
+
+        for (; x < width; x++)
+        {
+            std::memcpy(out + x * 8, in + x * 4, 4);
+            std::memcpy(out + x * 8 + 4, in + x * 4, 4);
+        }
+
+        std::memcpy(out + destinationStride, out, destinationStride);
+    }
+}
+
+// Scales a BGRA region down by 1, 2 or 4 into a tightly packed destination
+// The scratch buffer must hold (width / 2) * (height / 2) pixels for factor 4
+inline bool scale_bgra(const BYTE* source, const int width, const int height, const size_t sourceStride,
+                       const int factor, BYTE* destination, BYTE* scratch)
+{
+    switch (factor)
+    {
+    case 1:
+        copy_bgra(source, width, height, sourceStride, destination, width * 4);
+        return true;
+    case 2:
+        downscale_bgra_half(source, width, height, sourceStride, destination, (width / 2) * 4);
+        return true;
+    case 4:
+        if (!scratch) return false;
+        downscale_bgra_half(source, width, height, sourceStride, scratch, (width / 2) * 4);
+        downscale_bgra_half(scratch, width / 2, height / 2, (width / 2) * 4, destination, (width / 4) * 4);
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <Windows.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "FrameStats.h"
+#include "Timing.h"
+
+struct ColorThrottleSettings
+{
+    bool adaptive = false; // Off: every color frame is converted, as before
+    float max_fps = 30.0f; // Cap even with nothing under pressure
+    float body_budget = 0.004f; // s from body pickup to publish, color backs off past it
+    bool preview_visible = true; // Whoever shows the preview knows best, only probes go out while hidden
+};
+
+// Plain copy of what the throttle is doing right now
+struct ColorThrottleStats
+{
+    int level = 0; // 0 = unthrottled .. ColorThrottle::MaxLevel
+    float fps_cap = 0; // Color frames let through per second
+    int scale = 1; // Extra preview downscale on top of the preview mode
+    float consumer_fps = 0; // New color frames actually read per second
+    uint64_t throttled = 0; // Sensor frames skipped on purpose (not counted as dropped)
+    bool paused = false; // Hidden, or nobody's reading: only probing for readers
+};
+
+// Decides per color frame whether to convert it, from the body pipeline's recent timings
+// and how fast readers pick frames up; reevaluated every Window on the color path
+class ColorThrottle
+{
+public:
+    static constexpr int MaxLevel = 3;
+
+private:
+    static constexpr double Window = 0.5; // s between decisions
+    static constexpr int CalmWindows = 2; // Under half the budget this long before easing off
+    static constexpr double IdleTimeout = 2.0; // s without a read before the preview counts as unwatched
+    static constexpr float ProbeFps = 1.0f; // While unwatched, so a returning reader has something to read
+    static constexpr float MinFps = 5.0f;
+    static constexpr double SensorPeriod = 1.0 / 30;
+
+    // The color path only (one thread at a time)
+    int64_t started_ = 0, window_start_ = 0, next_frame_ = 0;
+    uint64_t window_body_frames_ = 0, window_late_frames_ = 0, window_reads_ = 0;
+    int64_t window_body_ticks_ = 0;
+    int calm_ = 0;
+
+    std::atomic<int> level_{0}, scale_{1};
+    std::atomic<float> fps_cap_{0.0f}, consumer_fps_{0.0f};
+    std::atomic<uint64_t> throttled_{0};
+    std::atomic<bool> paused_{false};
+
+    // Readers
+    std::atomic<uint64_t> reads_{0}, last_read_sequence_{0};
+    std::atomic<int64_t> last_read_{0};
+
+    void begin_window(const int64_t now, const FrameStatsSnapshot& stats)
+    {
+        window_start_ = now;
+        window_body_frames_ = stats.body_frames;
+        window_body_ticks_ = stats.body_processing_ticks;
+        window_late_frames_ = stats.late_body_frames;
+        window_reads_ = reads_.load(std::memory_order_relaxed);
+    }
+
+    void evaluate(const int64_t now, const FrameStats& frameStats, const ColorThrottleSettings& settings)
+    {
+        const auto stats = frameStats.snapshot();
+        const auto bodyFrames = stats.body_frames - window_body_frames_;
+        const auto late = stats.late_body_frames - window_late_frames_;
+        const auto mean = bodyFrames
+                              ? qpc_to_seconds((stats.body_processing_ticks - window_body_ticks_) /
+                                  static_cast<int64_t>(bodyFrames))
+                              : 0.0;
+
+        const auto reads = reads_.load(std::memory_order_relaxed) - window_reads_;
+        const auto consumerFps = static_cast<float>(reads / qpc_to_seconds(now - window_start_));
+        consumer_fps_.store(consumerFps, std::memory_order_relaxed);
+
+        // Back off at once, ease off slowly
+        auto level = level_.load(std::memory_order_relaxed);
+        if (mean > settings.body_budget || late > 0)
+        {
+            level = std::min(level + 1, MaxLevel);
+            calm_ = 0;
+        }
+        else if (mean < settings.body_budget / 2 && ++calm_ >= CalmWindows)
+        {
+            level = std::max(level - 1, 0);
+            calm_ = 0;
+        }
+
+        // No point converting faster than anyone reads (with room to notice them speeding up)
+        // While paused only probes were there to read, that says nothing about the reader
+        auto fps = level_fps(level, settings);
+        if (consumerFps > 0 && !paused_.load(std::memory_order_relaxed)) fps = std::min(fps, consumerFps * 1.5f);
+
+        level_.store(level, std::memory_order_relaxed);
+        scale_.store(level >= 2 ? 2 : 1, std::memory_order_relaxed);
+        fps_cap_.store(std::max(fps, MinFps), std::memory_order_relaxed);
+        begin_window(now, stats);
+    }
+
+    // 1: half rate, 2: half rate and size, 3: quarter rate and half size
+    static float level_fps(const int level, const ColorThrottleSettings& settings)
+    {
+        return std::max(settings.max_fps / (level == 0 ? 1 : level < MaxLevel ? 2 : 4), MinFps);
+    }
+
+    void clear()
+    {
+        started_ = window_start_ = next_frame_ = 0;
+        calm_ = 0;
+        level_.store(0, std::memory_order_relaxed);
+        scale_.store(1, std::memory_order_relaxed);
+        fps_cap_.store(0, std::memory_order_relaxed);
+        paused_.store(false, std::memory_order_relaxed);
+    }
+
+public:
+    // Called for every color frame from the sensor, false = skip it
+    bool admit(const int64_t now, const ColorThrottleSettings& settings, const FrameStats& stats)
+    {
+        if (!settings.adaptive)
+        {
+            if (started_) clear();
+            return true;
+        }
+
+        if (!started_)
+        {
+            started_ = now;
+            fps_cap_.store(level_fps(0, settings), std::memory_order_relaxed);
+            begin_window(now, stats.snapshot());
+        }
+        else if (now - window_start_ >= seconds_to_qpc(Window))
+            evaluate(now, stats, settings);
+
+        // Readers poll for new frames, so a long silence means nobody's looking
+        const auto lastSeen = std::max(last_read_.load(std::memory_order_relaxed), started_);
+        const auto watched = settings.preview_visible && now - lastSeen < seconds_to_qpc(IdleTimeout);
+        if (paused_.exchange(!watched, std::memory_order_relaxed) && watched)
+        {
+            // Back from a pause: the level's full rate right away, measured from here on
+            fps_cap_.store(level_fps(level_.load(std::memory_order_relaxed), settings), std::memory_order_relaxed);
+            begin_window(now, stats.snapshot());
+            next_frame_ = 0; // Not a second after the probe
+        }
+
+        // Hidden or unread alike: a probe now and then, so the preview isn't stale once it's back
+        const auto fps = watched ? fps_cap_.load(std::memory_order_relaxed) : ProbeFps;
+        if (now < next_frame_)
+        {
+            throttled_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Half a sensor frame early still counts, frames only come every 33ms
+        next_frame_ = now + seconds_to_qpc(1.0 / std::max(fps, ProbeFps) - SensorPeriod / 2);
+        return true;
+    }
+
+    // Readers: a color frame was handed out
+    void read(const uint64_t sequence)
+    {
+        if (!sequence || last_read_sequence_.exchange(sequence, std::memory_order_relaxed) == sequence) return;
+
+        reads_.fetch_add(1, std::memory_order_relaxed);
+        last_read_.store(qpc_now(), std::memory_order_relaxed);
+    }
+
+    // Extra downscale for the preview, 1 unless the body pipeline is under pressure
+    int scale() const
+    {
+        return scale_.load(std::memory_order_relaxed);
+    }
+
+    ColorThrottleStats stats() const
+    {
+        ColorThrottleStats stats;
+        stats.level = level_.load(std::memory_order_relaxed);
+        stats.fps_cap = fps_cap_.load(std::memory_order_relaxed);
+        stats.scale = scale_.load(std::memory_order_relaxed);
+        stats.consumer_fps = consumer_fps_.load(std::memory_order_relaxed);
+        stats.throttled = throttled_.load(std::memory_order_relaxed);
+        stats.paused = paused_.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <Windows.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "Timing.h"
+
+enum class ConnectionState
+{
+    Disconnected, // No sensor, or it's been gone for longer than a glitch
+    Opening, // Opened, waiting for the first frame
+    Streaming, // Body frames are arriving
+    Stalled // Frames stopped or the sensor dropped, everything's kept for its return
+};
+
+// Plain copy of the stall counters, durations in QPC ticks
+struct ConnectionStats
+{
+    ConnectionState state = ConnectionState::Disconnected;
+    uint64_t stalls = 0;
+    int64_t last_stall = 0, longest_stall = 0, total_stall = 0;
+    int64_t current_stall = 0; // So far, while Stalled
+};
+
+// Sensor connection as seen by the updater, from availability events and frame arrivals
+// Readers and buffers stay up through every state but Disconnected
+class ConnectionMonitor
+{
+    static constexpr double StallTimeout = 0.25; // s without a body frame, over 7 frames
+    static constexpr double DisconnectTimeout = 1.0; // s unavailable before giving up on a glitch
+
+    std::atomic<ConnectionState> state_{ConnectionState::Disconnected};
+    std::atomic<uint64_t> stalls_{0};
+    std::atomic<int64_t> stall_start_{0}, last_stall_{0}, longest_stall_{0}, total_stall_{0};
+
+    // Updater only
+    bool available_ = false;
+    int64_t last_frame_ = 0;
+
+    // Counted from the last frame that made it, not from when it was noticed
+    void stall(const int64_t now)
+    {
+        stall_start_.store(last_frame_ ? last_frame_ : now, std::memory_order_relaxed);
+        state_.store(ConnectionState::Stalled, std::memory_order_release);
+    }
+
+    static DWORD milliseconds_until(const int64_t due, const int64_t now)
+    {
+        return static_cast<DWORD>(std::max(qpc_to_seconds(due - now) * 1000.0, 0.0)) + 1;
+    }
+
+public:
+    ConnectionState state() const
+    {
+        return state_.load(std::memory_order_acquire);
+    }
+
+    // The sensor was opened (again)
+    void opening(const bool available)
+    {
+        available_ = available;
+        if (state() == ConnectionState::Disconnected)
+            state_.store(ConnectionState::Opening, std::memory_order_release);
+    }
+
+    void closed()
+    {
+        available_ = false;
+        state_.store(ConnectionState::Disconnected, std::memory_order_release);
+    }
+
+    // IsAvailableChanged, true if it should be reported as a disconnect right away
+    bool availability(const bool available, const int64_t now)
+    {
+        available_ = available;
+        if (available) return false;
+
+        // Only a running stream may ride out a drop, the timeout decides on the rest
+        if (state() == ConnectionState::Streaming) stall(now);
+        return state() != ConnectionState::Stalled;
+    }
+
+    // A body frame was picked up
+    void frame(const int64_t now)
+    {
+        last_frame_ = now;
+        available_ = true;
+        if (state() == ConnectionState::Streaming) return;
+
+        if (state() == ConnectionState::Stalled)
+        {
+            const auto duration = now - stall_start_.load(std::memory_order_relaxed);
+            last_stall_.store(duration, std::memory_order_relaxed);
+            total_stall_.fetch_add(duration, std::memory_order_relaxed);
+            if (duration > longest_stall_.load(std::memory_order_relaxed))
+                longest_stall_.store(duration, std::memory_order_relaxed);
+            stalls_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        state_.store(ConnectionState::Streaming, std::memory_order_release);
+    }
+
+    // How long the updater may wait before check() has something to do
+    DWORD timeout(const int64_t now) const
+    {
+        switch (state())
+        {
+        case ConnectionState::Streaming:
+            return milliseconds_until(last_frame_ + seconds_to_qpc(StallTimeout), now);
+        case ConnectionState::Stalled:
+            if (available_) return INFINITE; // Waiting for frames, however long it takes
+            return milliseconds_until(stall_start_.load(std::memory_order_relaxed) +
+                                      seconds_to_qpc(DisconnectTimeout), now);
+        default:
+            return INFINITE;
+        }
+    }
+
+    // After a timeout, true if the sensor should now be reported as gone
+    bool check(const int64_t now)
+    {
+        const auto state = this->state();
+        if (state == ConnectionState::Streaming && now - last_frame_ >= seconds_to_qpc(StallTimeout))
+            stall(now);
+
+        if (state == ConnectionState::Stalled && !available_ &&
+            now - stall_start_.load(std::memory_order_relaxed) >= seconds_to_qpc(DisconnectTimeout))
+        {
+            state_.store(ConnectionState::Disconnected, std::memory_order_release);
+            return true;
+        }
+
+        return false;
+    }
+
+    ConnectionStats stats() const
+    {
+        ConnectionStats stats;
+        stats.state = state();
+        stats.stalls = stalls_.load(std::memory_order_relaxed);
+        stats.last_stall = last_stall_.load(std::memory_order_relaxed);
+        stats.longest_stall = longest_stall_.load(std::memory_order_relaxed);
+        stats.total_stall = total_stall_.load(std::memory_order_relaxed);
+        if (stats.state == ConnectionState::Stalled)
+            stats.current_stall = qpc_now() - stall_start_.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+};
@@ -0,0 +1,176 @@
+#pragma once
+#include <Windows.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Fixed set of frame buffers shared between one writer and any readers
+// Readers lease the latest complete frame, the writer fills a free slot
+template <size_t SlotCount = 3>
+class FramePool
+{
+    static_assert(SlotCount >= 2, "The writer needs a slot besides the latest one");
+
+    struct Slot
+    {
+        std::unique_ptr<BYTE[]> data;
+        size_t capacity = 0;
+        size_t size = 0;
+        uint64_t sequence = 0;
+
+        // Leases held by readers, -1 while the writer owns the slot
+        std::atomic<int> references{0};
+    };
+
+    std::array<Slot, SlotCount> slots_;
+    std::atomic<int> latest_{-1};
+    std::atomic<uint64_t> sequence_{0};
+    int writing_ = -1; // Writer-only
+
+public:
+    // Read-only handle to one complete frame, returned to the pool on destruction
+    class Lease
+    {
+        Slot* slot_ = nullptr;
+
+    public:
+        Lease() = default;
+
+        explicit Lease(Slot* slot) : slot_(slot)
+        {
+        }
+
+        Lease(Lease&& other) noexcept : slot_(other.slot_)
+        {
+            other.slot_ = nullptr;
+        }
+
+        Lease& operator=(Lease&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                slot_ = other.slot_;
+                other.slot_ = nullptr;
+            }
+            return *this;
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ~Lease()
+        {
+            release();
+        }
+
+        void release()
+        {
+            if (slot_) slot_->references.fetch_sub(1, std::memory_order_release);
+            slot_ = nullptr;
+        }
+
+        explicit operator bool() const
+        {
+            return slot_ != nullptr;
+        }
+
+        const BYTE* data() const
+        {
+            return slot_ ? slot_->data.get() : nullptr;
+        }
+
+        size_t size() const
+        {
+            return slot_ ? slot_->size : 0;
+        }
+
+        uint64_t sequence() const
+        {
+            return slot_ ? slot_->sequence : 0;
+        }
+    };
+
+    // Lease the latest frame, or nothing if there's none newer than the given one
+    Lease acquire(const uint64_t newer_than = 0)
+    {
+        while (true)
+        {
+            const auto index = latest_.load(std::memory_order_acquire);
+            if (index < 0) return {}; // Nothing was published yet
+
+            auto& slot = slots_[index];
+            auto references = slot.references.load(std::memory_order_relaxed);
+            if (references < 0) continue; // Recycled by the writer, re-read the latest
+
+            if (!slot.references.compare_exchange_weak(
+                references, references + 1, std::memory_order_acquire))
+                continue; // Raced with another reader or the writer
+
+            Lease lease(&slot);
+            if (lease.sequence() <= newer_than) return {};
+            return lease;
+        }
+    }
+
+    // Claim a free slot of at least the given size, nullptr if all are leased
+    BYTE* begin_write(const size_t size)
+    {
+        const auto latest = latest_.load(std::memory_order_relaxed);
+        for (int i = 0; i < static_cast<int>(SlotCount); i++)
+        {
+            if (i == latest) continue; // Keep the latest frame readable
+
+            auto& slot = slots_[i];
+            auto expected = 0;
+            if (!slot.references.compare_exchange_strong(
+                expected, -1, std::memory_order_acquire))
+                continue; // Someone's still reading this one
+
+            // Only reallocated when the frame size changes
+            if (slot.capacity < size)
+            {
+                slot.data.reset(new BYTE[size]);
+                slot.capacity = size;
+            }
+
+            slot.size = size;
+            writing_ = i;
+            return slot.data.get();
+        }
+
+        return nullptr;
+    }
+
+    // Publish the frame written since begin_write as the latest one
+    uint64_t commit_write()
+    {
+        if (writing_ < 0) return sequence_.load(std::memory_order_relaxed);
+
+        auto& slot = slots_[writing_];
+        slot.sequence = sequence_.load(std::memory_order_relaxed) + 1;
+        slot.references.store(0, std::memory_order_release);
+
+        latest_.store(writing_, std::memory_order_release);
+        sequence_.store(slot.sequence, std::memory_order_release);
+
+        writing_ = -1;
+        return slot.sequence;
+    }
+
+    // Give the claimed slot back without publishing it
+    void cancel_write()
+    {
+        if (writing_ < 0) return;
+        slots_[writing_].references.store(0, std::memory_order_release);
+        writing_ = -1;
+    }
+
+    // Sequence number of the latest published frame, 0 if none
+    uint64_t sequence() const
+    {
+        return sequence_.load(std::memory_order_acquire);
+    }
+};
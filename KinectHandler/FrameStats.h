@@ -0,0 +1,152 @@
+#pragma once
+#include <Windows.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "Timing.h"
+
+// Plain copy of the counters, consistent enough for diagnostics
+struct FrameStatsSnapshot
+{
+    static constexpr size_t LatencyBuckets = 9; // <1, <2, <4 .. <128, >=128 ms
+
+    uint64_t body_frames = 0;
+    uint64_t dropped_body_frames = 0; // Missing from the RelativeTime sequence
+    uint64_t late_body_frames = 0; // Delivered over a frame later than expected
+
+    uint64_t color_frames = 0;
+    uint64_t dropped_color_frames = 0; // Converter busy or every pool slot leased
+
+    int64_t body_arrival = 0; // QPC: the last body frame was picked up
+    int64_t body_published = 0; // QPC: ...and its snapshot published
+    int64_t color_published = 0; // QPC: the last color frame was converted
+    int64_t consumer_read = 0; // QPC: the last snapshot read by a consumer
+
+    int64_t body_processing_ticks = 0, body_processing_max = 0; // Totals over body_frames
+    int64_t color_processing_ticks = 0, color_processing_max = 0; // Totals over color_frames
+
+    uint64_t reads = 0;
+    int64_t read_latency_ticks = 0; // Total of body arrival -> consumer read
+    std::array<uint64_t, LatencyBuckets> read_latency{};
+};
+
+// Always-on frame counters, written by the workers with relaxed atomics only
+class FrameStats
+{
+    static constexpr TIMESPAN BodyFramePeriod = 333333; // 30 fps in 100ns ticks
+
+    std::atomic<uint64_t> body_frames_{0}, dropped_body_frames_{0}, late_body_frames_{0};
+    std::atomic<uint64_t> color_frames_{0}, dropped_color_frames_{0};
+
+    std::atomic<int64_t> body_arrival_{0}, body_published_{0}, color_published_{0}, consumer_read_{0};
+    std::atomic<int64_t> body_processing_ticks_{0}, body_processing_max_{0};
+    std::atomic<int64_t> color_processing_ticks_{0}, color_processing_max_{0};
+
+    std::atomic<uint64_t> reads_{0};
+    std::atomic<int64_t> read_latency_ticks_{0};
+    std::array<std::atomic<uint64_t>, FrameStatsSnapshot::LatencyBuckets> read_latency_{};
+
+    TIMESPAN last_timestamp_ = 0; // Body writer only
+
+    static void raise(std::atomic<int64_t>& maximum, const int64_t value)
+    {
+        auto current = maximum.load(std::memory_order_relaxed);
+        while (value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed));
+    }
+
+public:
+    // The updater thread: one body frame from pickup to publish
+    void body_frame(const TIMESPAN timestamp, const int64_t arrival, const int64_t published)
+    {
+        if (last_timestamp_ > 0 && timestamp > last_timestamp_)
+        {
+            const auto frameGap = timestamp - last_timestamp_;
+            const auto missed = (frameGap + BodyFramePeriod / 2) / BodyFramePeriod - 1;
+            if (missed > 0) dropped_body_frames_.fetch_add(missed, std::memory_order_relaxed);
+
+            // Compare the delivery gap with the sensor's, any extra was spent in the pipeline
+            const auto previous = body_arrival_.load(std::memory_order_relaxed);
+            const auto deliveryGap = seconds_to_qpc(static_cast<double>(frameGap) / 1e7);
+            if (previous > 0 && arrival - previous - deliveryGap > seconds_to_qpc(BodyFramePeriod / 1e7))
+                late_body_frames_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        last_timestamp_ = timestamp;
+        body_arrival_.store(arrival, std::memory_order_relaxed);
+        body_published_.store(published, std::memory_order_relaxed);
+
+        body_processing_ticks_.fetch_add(published - arrival, std::memory_order_relaxed);
+        raise(body_processing_max_, published - arrival);
+        body_frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Whoever converts color: one frame handed to the pool, or dropped
+    void color_frame(const int64_t arrival, const bool published)
+    {
+        if (!published)
+        {
+            dropped_color_frames_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const auto now = qpc_now();
+        color_published_.store(now, std::memory_order_relaxed);
+        color_processing_ticks_.fetch_add(now - arrival, std::memory_order_relaxed);
+        raise(color_processing_max_, now - arrival);
+        color_frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Any consumer: a snapshot that arrived at the given QPC time was read now
+    void consumer_read(const int64_t arrival)
+    {
+        if (arrival <= 0) return; // Nothing was tracked yet
+
+        const auto now = qpc_now();
+        consumer_read_.store(now, std::memory_order_relaxed);
+
+        const auto latency = now - arrival;
+        read_latency_ticks_.fetch_add(latency, std::memory_order_relaxed);
+        reads_.fetch_add(1, std::memory_order_relaxed);
+
+        // Power-of-two millisecond buckets
+        auto milliseconds = static_cast<uint64_t>(std::max(qpc_to_seconds(latency) * 1000.0, 0.0));
+        size_t bucket = 0;
+        while (milliseconds > 0 && bucket + 1 < read_latency_.size())
+        {
+            milliseconds >>= 1;
+            bucket++;
+        }
+
+        read_latency_[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    FrameStatsSnapshot snapshot() const
+    {
+        FrameStatsSnapshot stats;
+        stats.body_frames = body_frames_.load(std::memory_order_relaxed);
+        stats.dropped_body_frames = dropped_body_frames_.load(std::memory_order_relaxed);
+        stats.late_body_frames = late_body_frames_.load(std::memory_order_relaxed);
+        stats.color_frames = color_frames_.load(std::memory_order_relaxed);
+        stats.dropped_color_frames = dropped_color_frames_.load(std::memory_order_relaxed);
+
+        stats.body_arrival = body_arrival_.load(std::memory_order_relaxed);
+        stats.body_published = body_published_.load(std::memory_order_relaxed);
+        stats.color_published = color_published_.load(std::memory_order_relaxed);
+        stats.consumer_read = consumer_read_.load(std::memory_order_relaxed);
+
+        stats.body_processing_ticks = body_processing_ticks_.load(std::memory_order_relaxed);
+        stats.body_processing_max = body_processing_max_.load(std::memory_order_relaxed);
+        stats.color_processing_ticks = color_processing_ticks_.load(std::memory_order_relaxed);
+        stats.color_processing_max = color_processing_max_.load(std::memory_order_relaxed);
+
+        stats.reads = reads_.load(std::memory_order_relaxed);
+        stats.read_latency_ticks = read_latency_ticks_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < read_latency_.size(); i++)
+            stats.read_latency[i] = read_latency_[i].load(std::memory_order_relaxed);
+
+        return stats;
+    }
+};
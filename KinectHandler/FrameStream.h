@@ -0,0 +1,115 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+#include <atlbase.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "FramePool.h"
+
+// One optional 16-bit stream (depth or infrared) with its own reader and frames
+// Opened only while enabled, so nobody pays for it by default
+template <typename Source, typename Reader, typename ArrivedArgs, typename Reference, typename Frame>
+class RawFrameStream
+{
+    Reader* reader_ = nullptr;
+    WAITABLE_HANDLE event_ = NULL;
+    FramePool<3> frames_;
+    std::atomic<bool> enabled_{false};
+
+public:
+    ~RawFrameStream()
+    {
+        close();
+    }
+
+    bool open(Source* source)
+    {
+        if (reader_) return true;
+        if (!source || FAILED(source->OpenReader(&reader_)) || !reader_)
+        {
+            reader_ = nullptr;
+            return false;
+        }
+
+        reader_->SubscribeFrameArrived(&event_);
+        return true;
+    }
+
+    void close()
+    {
+        if (!reader_) return;
+        reader_->UnsubscribeFrameArrived(event_);
+        reader_->Release();
+
+        event_ = NULL;
+        reader_ = nullptr;
+    }
+
+    bool is_open() const
+    {
+        return reader_ != nullptr;
+    }
+
+    HANDLE wait_handle() const
+    {
+        return reader_ ? reinterpret_cast<HANDLE>(event_) : nullptr;
+    }
+
+    // Copy the signaled frame into the pool, false if there was none or no free slot
+    bool read()
+    {
+        CComPtr<ArrivedArgs> args;
+        if (!reader_ || FAILED(reader_->GetFrameArrivedEventData(event_, &args)) || !args)
+            return false;
+
+        CComPtr<Reference> frameReference;
+        args->get_FrameReference(&frameReference);
+        if (!frameReference) return false;
+
+        CComPtr<Frame> frame;
+        frameReference->AcquireFrame(&frame);
+        if (!frame) return false;
+
+        UINT count = 0;
+        UINT16* buffer = nullptr;
+        if (FAILED(frame->AccessUnderlyingBuffer(&count, &buffer)) || !buffer) return false;
+
+        const auto size = static_cast<size_t>(count) * sizeof(UINT16);
+        const auto destination = frames_.begin_write(size);
+        if (!destination) return false; // Every slot is leased, drop this one
+
+        std::memcpy(destination, buffer, size);
+        frames_.commit_write();
+        return true;
+    }
+
+    void enabled(const bool enabled)
+    {
+        enabled_ = enabled;
+    }
+
+    bool enabled() const
+    {
+        return enabled_;
+    }
+
+    // Raw UINT16 pixels (millimeters for depth, intensity for infrared)
+    FramePool<3>::Lease frame(const uint64_t newer_than = 0)
+    {
+        return frames_.acquire(newer_than);
+    }
+
+    uint64_t frame_count() const
+    {
+        return frames_.sequence();
+    }
+};
+
+using DepthStream = RawFrameStream<IDepthFrameSource, IDepthFrameReader,
+                                   IDepthFrameArrivedEventArgs, IDepthFrameReference, IDepthFrame>;
+
+using InfraredStream = RawFrameStream<IInfraredFrameSource, IInfraredFrameReader,
+                                      IInfraredFrameArrivedEventArgs, IInfraredFrameReference, IInfraredFrame>;
@@ -0,0 +1,141 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <array>
+#include <cstdint>
+#include <xmmintrin.h>
+
+#include "SkeletonSnapshot.h"
+
+enum GestureFlags : uint32_t
+{
+    Gesture_None = 0,
+    Gesture_PauseLeft = 1 << 0,
+    Gesture_PauseRight = 1 << 1,
+    Gesture_PointLeft = 1 << 2,
+    Gesture_PointRight = 1 << 3,
+    Gesture_Count = 4
+};
+
+// Compact result of one body frame, published next to the snapshot
+struct GestureState
+{
+    uint32_t active = Gesture_None; // Poses held right now
+    std::array<uint32_t, Gesture_Count> triggers{}; // Times each gesture fired, compare to the last seen
+    uint64_t sequence = 0;
+};
+
+// Fires after a pose is held for 1s, then every 3s while it's still held
+class GestureTimer
+{
+    static constexpr TIMESPAN FireDelay = 10000000; // 1s
+    static constexpr TIMESPAN RepeatDelay = 30000000; // 3s
+
+    bool held_ = false, blocked_ = false;
+    TIMESPAN start_ = 0;
+
+public:
+    bool update(const bool value, const TIMESPAN now)
+    {
+        if (!held_)
+        {
+            blocked_ = false;
+            start_ = now;
+            held_ = value;
+            return false;
+        }
+
+        held_ = value;
+
+        const auto elapsed = now - start_;
+        if (elapsed >= FireDelay && !blocked_)
+        {
+            blocked_ = true;
+            return true;
+        }
+
+        if (elapsed >= RepeatDelay && blocked_)
+        {
+            blocked_ = false;
+            start_ = now;
+            return true;
+        }
+
+        return false;
+    }
+};
+
+// Arm pause/point poses, evaluated once per body frame for both arms at once
+class GestureStage
+{
+    std::array<GestureTimer, Gesture_Count> timers_{};
+    GestureState state_;
+
+    static __m128 load(const CameraSpacePoint& point)
+    {
+        return _mm_set_ps(0, point.Z, point.Y, point.X);
+    }
+
+    static __m128 normalize(const __m128 vector)
+    {
+        const auto squared = _mm_mul_ps(vector, vector);
+        const auto length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(
+            _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(0, 0, 0, 0)),
+            _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(1, 1, 1, 1))),
+            _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 2, 2, 2))));
+
+        return _mm_div_ps(vector, length);
+    }
+
+public:
+    const GestureState& push(const SkeletonSnapshot& snapshot)
+    {
+        const auto& joints = snapshot.joints;
+        auto active = static_cast<uint32_t>(Gesture_None);
+
+        if (snapshot.tracked)
+        {
+            const auto shoulderLeft = load(joints[JointType_ShoulderLeft].Position);
+            const auto shoulderRight = load(joints[JointType_ShoulderRight].Position);
+
+            // Upper arms, forearms and the shoulder line, normalized
+            const auto upperLeft = normalize(_mm_sub_ps(load(joints[JointType_ElbowLeft].Position), shoulderLeft));
+            const auto upperRight = normalize(_mm_sub_ps(load(joints[JointType_ElbowRight].Position), shoulderRight));
+            const auto lowerLeft = normalize(_mm_sub_ps(
+                load(joints[JointType_WristLeft].Position), load(joints[JointType_ElbowLeft].Position)));
+            const auto lowerRight = normalize(_mm_sub_ps(
+                load(joints[JointType_WristRight].Position), load(joints[JointType_ElbowRight].Position)));
+            const auto across = normalize(_mm_sub_ps(shoulderLeft, shoulderRight));
+
+            // Transpose into lanes of (straight L, tilt L, straight R, tilt R) pairs
+            auto x0 = upperLeft, y0 = across, z0 = upperRight, w0 = _mm_sub_ps(_mm_setzero_ps(), across);
+            auto x1 = lowerLeft, y1 = lowerLeft, z1 = lowerRight, w1 = lowerRight;
+            _MM_TRANSPOSE4_PS(x0, y0, z0, w0);
+            _MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+
+            alignas(16) float dots[4], down[4];
+            _mm_store_ps(dots, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x0, x1), _mm_mul_ps(y0, y1)), _mm_mul_ps(z0, z1)));
+            _mm_store_ps(down, _mm_sub_ps(_mm_setzero_ps(), y1)); // Forearms dotted with (0, -1, 0)
+
+            const auto straightLeft = dots[0] > 0.9f, straightRight = dots[2] > 0.9f;
+            const auto tiltLeft = dots[1], tiltRight = dots[3];
+            const auto downLeft = down[0], downRight = down[2];
+
+            if (straightLeft && tiltLeft > 0.4f && tiltLeft < 0.7f) active |= Gesture_PauseLeft;
+            if (straightRight && tiltRight > 0.4f && tiltRight < 0.7f) active |= Gesture_PauseRight;
+
+            if (straightLeft && tiltLeft > -0.5f && tiltLeft < 0.5f && downLeft > -0.3f && downLeft < 0.7f)
+                active |= Gesture_PointLeft;
+            if (straightRight && tiltRight > -0.5f && tiltRight < 0.5f && downRight > -0.3f && downRight < 0.7f)
+                active |= Gesture_PointRight;
+        }
+
+        state_.active = active;
+        for (size_t i = 0; i < Gesture_Count; i++)
+            if (timers_[i].update(active & (1u << i), snapshot.timestamp)) state_.triggers[i]++;
+
+        state_.sequence = snapshot.sequence;
+        return state_;
+    }
+};
@@ -0,0 +1,154 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <array>
+#include <cmath>
+
+#include "SkeletonSnapshot.h"
+
+enum class JointFilterType
+{
+    None,
+    OneEuro,
+    DoubleExponential
+};
+
+struct JointFilterSettings
+{
+    JointFilterType type = JointFilterType::None;
+
+    // One Euro: cutoff = min_cutoff + beta * |speed|
+    float min_cutoff = 1.0f; // Hz
+    float beta = 0.5f;
+    float derivative_cutoff = 1.0f; // Hz
+
+    // Double exponential (Holt): value and trend smoothing
+    float smoothing = 0.5f;
+    float correction = 0.25f;
+};
+
+// One filter state per joint and channel (position xyz + orientation xyzw)
+// Laid out as channel-major arrays, so every loop runs over contiguous floats
+class JointFilterBank
+{
+    static constexpr size_t Channels = 7;
+    static constexpr float MaxFrameGap = 0.5f; // Seconds, reset after longer gaps (short stalls are kept)
+
+    using Lanes = std::array<float, JointType_Count>;
+
+    alignas(16) std::array<Lanes, Channels> input_{};
+    alignas(16) std::array<Lanes, Channels> value_{};
+    alignas(16) std::array<Lanes, Channels> trend_{}; // Derivative (One Euro) or trend (Holt)
+
+    JointFilterType type_ = JointFilterType::None;
+    TIMESPAN last_timestamp_ = 0;
+    bool primed_ = false;
+
+    void gather(const SkeletonSnapshot& snapshot)
+    {
+        for (size_t i = 0; i < JointType_Count; i++)
+        {
+            const auto& position = snapshot.joints[i].Position;
+            auto orientation = snapshot.orientations[i].Orientation;
+
+            // Keep quaternions in the same hemisphere as the filtered ones
+            if (primed_ && orientation.x * value_[3][i] + orientation.y * value_[4][i] +
+                orientation.z * value_[5][i] + orientation.w * value_[6][i] < 0)
+                orientation = Vector4{-orientation.x, -orientation.y, -orientation.z, -orientation.w};
+
+            input_[0][i] = position.X;
+            input_[1][i] = position.Y;
+            input_[2][i] = position.Z;
+            input_[3][i] = orientation.x;
+            input_[4][i] = orientation.y;
+            input_[5][i] = orientation.z;
+            input_[6][i] = orientation.w;
+        }
+    }
+
+    void scatter(SkeletonSnapshot& snapshot) const
+    {
+        for (size_t i = 0; i < JointType_Count; i++)
+        {
+            snapshot.joints[i].Position = CameraSpacePoint{value_[0][i], value_[1][i], value_[2][i]};
+
+            const auto length = std::sqrt(value_[3][i] * value_[3][i] + value_[4][i] * value_[4][i] +
+                value_[5][i] * value_[5][i] + value_[6][i] * value_[6][i]);
+            if (length > 1e-6f) // Leave untracked (zero) orientations alone
+                snapshot.orientations[i].Orientation = Vector4{
+                    value_[3][i] / length, value_[4][i] / length, value_[5][i] / length, value_[6][i] / length
+                };
+        }
+    }
+
+    static float smoothing_factor(const float seconds, const float cutoff)
+    {
+        const auto tau = 1.0f / (2.0f * 3.14159265f * cutoff);
+        return 1.0f / (1.0f + tau / seconds);
+    }
+
+    void one_euro(const float seconds, const JointFilterSettings& settings)
+    {
+        const auto derivativeAlpha = smoothing_factor(seconds, settings.derivative_cutoff);
+        for (size_t c = 0; c < Channels; c++)
+            for (size_t i = 0; i < JointType_Count; i++)
+            {
+                const auto speed = (input_[c][i] - value_[c][i]) / seconds;
+                trend_[c][i] += derivativeAlpha * (speed - trend_[c][i]);
+
+                const auto alpha = smoothing_factor(
+                    seconds, settings.min_cutoff + settings.beta * std::fabs(trend_[c][i]));
+                value_[c][i] += alpha * (input_[c][i] - value_[c][i]);
+            }
+    }
+
+    void double_exponential(const JointFilterSettings& settings)
+    {
+        const auto alpha = settings.smoothing, gamma = settings.correction;
+        for (size_t c = 0; c < Channels; c++)
+            for (size_t i = 0; i < JointType_Count; i++)
+            {
+                const auto previous = value_[c][i];
+                value_[c][i] = alpha * input_[c][i] + (1.0f - alpha) * (previous + trend_[c][i]);
+                trend_[c][i] = gamma * (value_[c][i] - previous) + (1.0f - gamma) * trend_[c][i];
+            }
+    }
+
+public:
+    void reset()
+    {
+        primed_ = false;
+    }
+
+    // Filter one body frame, allocation-free; the output keeps raw metadata
+    void apply(const SkeletonSnapshot& raw, SkeletonSnapshot& filtered, const JointFilterSettings& settings)
+    {
+        filtered = raw;
+
+        const auto seconds = static_cast<float>(raw.timestamp - last_timestamp_) / 1e7f;
+        last_timestamp_ = raw.timestamp;
+
+        // Start over on tracking loss, long gaps or a filter change
+        if (settings.type == JointFilterType::None || !raw.tracked ||
+            settings.type != type_ || seconds <= 0 || seconds > MaxFrameGap)
+            primed_ = false;
+
+        type_ = settings.type;
+        if (settings.type == JointFilterType::None || !raw.tracked) return;
+
+        gather(raw);
+        if (!primed_)
+        {
+            value_ = input_;
+            for (auto& lanes : trend_) lanes.fill(0);
+            primed_ = true;
+            return;
+        }
+
+        if (settings.type == JointFilterType::OneEuro) one_euro(seconds, settings);
+        else double_exponential(settings);
+
+        scatter(filtered);
+    }
+};
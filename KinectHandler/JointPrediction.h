@@ -0,0 +1,142 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "SkeletonSnapshot.h"
+
+// Quaternion helpers for Kinect's (x, y, z, w) orientations
+inline Vector4 quaternion_multiply(const Vector4& a, const Vector4& b)
+{
+    return Vector4{
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    };
+}
+
+inline Vector4 quaternion_conjugate(const Vector4& q)
+{
+    return Vector4{-q.x, -q.y, -q.z, q.w};
+}
+
+inline Vector4 quaternion_normalize(const Vector4& q)
+{
+    const auto length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    if (length < 1e-6f) return Vector4{0, 0, 0, 1};
+    return Vector4{q.x / length, q.y / length, q.z / length, q.w / length};
+}
+
+// Rotation vector (axis * angle) of a unit quaternion, shortest arc
+inline CameraSpacePoint quaternion_log(Vector4 q)
+{
+    if (q.w < 0) q = Vector4{-q.x, -q.y, -q.z, -q.w};
+
+    const auto sine = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z);
+    if (sine < 1e-6f) return CameraSpacePoint{0, 0, 0};
+
+    const auto scale = 2.0f * std::atan2(sine, q.w) / sine;
+    return CameraSpacePoint{q.x * scale, q.y * scale, q.z * scale};
+}
+
+inline Vector4 quaternion_exp(const CameraSpacePoint& rotation)
+{
+    const auto angle = std::sqrt(rotation.X * rotation.X + rotation.Y * rotation.Y + rotation.Z * rotation.Z);
+    if (angle < 1e-6f) return Vector4{0, 0, 0, 1};
+
+    const auto scale = std::sin(angle / 2.0f) / angle;
+    return Vector4{rotation.X * scale, rotation.Y * scale, rotation.Z * scale, std::cos(angle / 2.0f)};
+}
+
+// The newest frame plus per-joint velocities, enough to extrapolate without history
+struct PredictionModel
+{
+    SkeletonSnapshot base;
+    std::array<CameraSpacePoint, JointType_Count> velocity{}; // m/s
+    std::array<CameraSpacePoint, JointType_Count> angular_velocity{}; // rad/s, rotation vector
+};
+
+// Keeps the last few body frames and derives velocities from their RelativeTime
+class JointPredictor
+{
+    static constexpr size_t HistorySize = 3;
+    static constexpr TIMESPAN MaxFrameGap = 5000000; // 500ms, treat as a fresh start (rides out short stalls)
+
+    std::array<SkeletonSnapshot, HistorySize> history_{};
+    size_t count_ = 0, newest_ = 0;
+    PredictionModel model_;
+
+public:
+    void reset()
+    {
+        count_ = 0;
+    }
+
+    const PredictionModel& push(const SkeletonSnapshot& snapshot)
+    {
+        // Restart after tracking losses or long gaps, stale velocities just overshoot
+        if (!snapshot.tracked || (count_ > 0 && snapshot.timestamp - history_[newest_].timestamp > MaxFrameGap))
+            count_ = 0;
+
+        newest_ = (newest_ + 1) % HistorySize;
+        history_[newest_] = snapshot;
+        if (snapshot.tracked && count_ < HistorySize) count_++;
+
+        model_.base = snapshot;
+        model_.velocity.fill({});
+        model_.angular_velocity.fill({});
+        if (count_ < 2) return model_;
+
+        // Difference against the oldest sample we have, that's less noisy than the last one
+        const auto& oldest = history_[(newest_ + HistorySize - (count_ - 1)) % HistorySize];
+        const auto seconds = static_cast<float>(snapshot.timestamp - oldest.timestamp) / 1e7f;
+        if (seconds <= 0) return model_;
+
+        for (size_t i = 0; i < JointType_Count; i++)
+        {
+            if (snapshot.joints[i].TrackingState == TrackingState_NotTracked ||
+                oldest.joints[i].TrackingState == TrackingState_NotTracked)
+                continue; // Don't extrapolate guesses of nothing
+
+            const auto& now = snapshot.joints[i].Position;
+            const auto& then = oldest.joints[i].Position;
+            model_.velocity[i] = CameraSpacePoint{
+                (now.X - then.X) / seconds, (now.Y - then.Y) / seconds, (now.Z - then.Z) / seconds
+            };
+
+            const auto& delta = quaternion_log(quaternion_multiply(
+                snapshot.orientations[i].Orientation, quaternion_conjugate(oldest.orientations[i].Orientation)));
+            model_.angular_velocity[i] = CameraSpacePoint{delta.X / seconds, delta.Y / seconds, delta.Z / seconds};
+        }
+
+        return model_;
+    }
+};
+
+// Move the model's newest frame forward by the given time
+inline SkeletonSnapshot extrapolate(const PredictionModel& model, const float seconds)
+{
+    auto snapshot = model.base;
+    if (seconds <= 0) return snapshot;
+
+    for (size_t i = 0; i < JointType_Count; i++)
+    {
+        auto& position = snapshot.joints[i].Position;
+        position.X += model.velocity[i].X * seconds;
+        position.Y += model.velocity[i].Y * seconds;
+        position.Z += model.velocity[i].Z * seconds;
+
+        const auto& rotation = model.angular_velocity[i];
+        if (rotation.X == 0 && rotation.Y == 0 && rotation.Z == 0) continue;
+
+        auto& orientation = snapshot.orientations[i].Orientation;
+        orientation = quaternion_normalize(quaternion_multiply(quaternion_exp(
+            CameraSpacePoint{rotation.X * seconds, rotation.Y * seconds, rotation.Z * seconds}), orientation));
+    }
+
+    return snapshot;
+}
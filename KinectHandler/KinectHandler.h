@@ -4,6 +4,8 @@
 #include "KinectWrapper.h"
 #pragma managed
 
+#include <vcclr.h>
+
 using namespace System;
 using namespace Numerics;
 using namespace Collections::Generic;
@@ -29,6 +31,135 @@ namespace KinectHandler
         property int JointRole;
     };
 
+    // Blittable joint, filled in bulk by the CopyXKinectJoints calls
+    [StructLayout(LayoutKind::Sequential)]
+    public value struct KinectJointData
+    {
+        Vector3 Position;
+        Quaternion Orientation;
+
+        int TrackingState;
+        int JointRole;
+    };
+
+    public enum class KinectMmcssTask
+    {
+        None,
+        Games,
+        ProAudio // "Pro Audio"
+    };
+
+    public enum class KinectThreadPriority
+    {
+        Default, // Highest with split readers, normal otherwise
+        Normal,
+        AboveNormal,
+        Highest,
+        TimeCritical
+    };
+
+    public enum class JointOrientationSource
+    {
+        Sensor, // Whatever Kinect reports (nothing for the foot and hand tips)
+        Derived // Built natively from the surrounding joint positions
+    };
+
+    public enum class KinectConnectionState
+    {
+        Disconnected, // No sensor, or it's been gone for longer than a glitch
+        Opening, // Opened, waiting for the first frame
+        Streaming, // Body frames are arriving
+        Stalled // Frames stopped for a moment, tracking resumes where it left off
+    };
+
+    // Frame counters and timings since the handler was created
+    public value struct KinectFrameStats
+    {
+        UInt64 BodyFrames;
+        UInt64 DroppedBodyFrames; // Never delivered by the sensor
+        UInt64 LateBodyFrames; // Delivered over a frame late
+
+        UInt64 ColorFrames;
+        UInt64 DroppedColorFrames; // Skipped while converting or with every buffer in use
+
+        TimeSpan BodyDataAge; // Since the last body frame was picked up
+        TimeSpan MeanBodyProcessing, MaxBodyProcessing;
+        TimeSpan MeanColorProcessing, MaxColorProcessing;
+
+        UInt64 Reads;
+        TimeSpan MeanReadLatency; // Body frame pickup -> joints handed out
+
+        // Reads by latency: <1ms, <2ms, <4ms ... <128ms, >=128ms
+        array<UInt64>^ ReadLatencyHistogram;
+
+        UInt64 Stalls; // Ridden out without a disconnect
+        TimeSpan LastStall, LongestStall, TotalStall;
+
+        // How the updater thread is actually scheduled
+        KinectMmcssTask UpdaterMmcssTask; // None if registration failed
+        int UpdaterPriority; // Win32 thread priority
+        UInt64 UpdaterAffinity; // 0 = any core
+
+        // Adaptive camera mode, idle while it's off (skipped frames keep adding up)
+        int ColorThrottleLevel; // 0 = unthrottled .. 3
+        float ColorFrameRateCap, ConsumerColorFrameRate; // Per second
+        int ColorThrottleScale; // Extra downscale on top of PreviewMode
+        UInt64 ThrottledColorFrames; // Skipped on purpose, not counted as dropped
+        bool IsColorPaused; // Hidden or unread, only probing for readers
+
+        virtual String^ ToString() override
+        {
+            return String::Format(
+                "Body: {0} frames ({1} dropped, {2} late), {3:F2}ms mean / {4:F2}ms max processing, "
+                "Color: {5} frames ({6} dropped), {7:F2}ms mean / {8:F2}ms max processing, "
+                "Reads: {9}, {10:F2}ms mean latency, histogram [{11}], "
+                "Stalls: {12} ({13:F0}ms last, {14:F0}ms longest), "
+                "Updater: MMCSS {15}, priority {16}, affinity 0x{17:X}, "
+                "Color throttle: level {18}, {19:F1} fps cap, {20:F1} fps read, {21} skipped, paused {22}",
+                BodyFrames, DroppedBodyFrames, LateBodyFrames,
+                MeanBodyProcessing.TotalMilliseconds, MaxBodyProcessing.TotalMilliseconds,
+                ColorFrames, DroppedColorFrames,
+                MeanColorProcessing.TotalMilliseconds, MaxColorProcessing.TotalMilliseconds,
+                Reads, MeanReadLatency.TotalMilliseconds,
+                ReadLatencyHistogram != nullptr ? String::Join<UInt64>(", ", ReadLatencyHistogram) : "",
+                Stalls, LastStall.TotalMilliseconds, LongestStall.TotalMilliseconds,
+                UpdaterMmcssTask, UpdaterPriority, UpdaterAffinity,
+                ColorThrottleLevel, ColorFrameRateCap, ConsumerColorFrameRate, ThrottledColorFrames,
+                IsColorPaused);
+        }
+    };
+
+    public enum class CameraPreviewMode
+    {
+        Full, // 1920x1080
+        Half, // 960x540
+        Quarter // 480x270
+    };
+
+    public enum class JointFilter
+    {
+        None,
+        OneEuro,
+        DoubleExponential
+    };
+
+    public enum class BodySelectionPolicy
+    {
+        LockFirst, // Keep the first tracked user until they leave
+        Closest, // Follow whoever's nearest to the sensor
+        Manual // Follow SelectedBodyId, if they're in view
+    };
+
+    [Flags]
+    public enum class KinectGesture
+    {
+        None = 0,
+        PauseLeft = 1 << 0,
+        PauseRight = 1 << 1,
+        PointLeft = 1 << 2,
+        PointRight = 1 << 3
+    };
+
     delegate void FunctionToCallDelegate();
 
     public ref class KinectHandler
@@ -36,15 +167,130 @@ namespace KinectHandler
     private:
         KinectWrapper* kinect_;
         FunctionToCallDelegate^ function_;
+        FunctionToCallDelegate^ body_frame_function_;
+        array<BYTE>^ image_buffer_;
+
+        // Grab one consistent frame for all joints
+        List<KinectJoint^>^ ToKinectJoints(const SkeletonSnapshot& snapshot)
+        {
+            kinect_->mark_consumed(snapshot);
+
+            const auto& positions = KinectWrapper::gather_joints(snapshot.joints);
+            const auto& orientations = KinectWrapper::gather_joints(snapshot.orientations);
+
+            auto trackedKinectJoints = gcnew List<KinectJoint^>(static_cast<int>(positions.size()));
+            for (auto i = 0; i < static_cast<int>(positions.size()); i++)
+            {
+                auto joint = gcnew KinectJoint(i);
+                joint->TrackingState = positions[i].TrackingState;
+
+                joint->Position = Vector3(
+                    positions[i].Position.X,
+                    positions[i].Position.Y,
+                    positions[i].Position.Z);
+
+                joint->Orientation = Quaternion(
+                    orientations[i].Orientation.x,
+                    orientations[i].Orientation.y,
+                    orientations[i].Orientation.z,
+                    orientations[i].Orientation.w);
+
+                trackedKinectJoints->Add(joint);
+            }
+
+            return trackedKinectJoints;
+        }
+
+        // Fill the caller's array in TrackedJointType order, returns the joint count
+        // Only the followed body's snapshots count as consumer reads
+        int CopyKinectJoints(const SkeletonSnapshot& snapshot, array<KinectJointData>^ destination,
+                             const bool followed = true)
+        {
+            if (destination == nullptr) return 0;
+            const auto count = std::min(destination->Length, static_cast<int>(TrackedJointType::JointManual));
+            if (count <= 0) return 0;
+            if (followed) kinect_->mark_consumed(snapshot);
+
+            // Already in Amethyst order, no per-joint remapping left
+            const auto& positions = KinectWrapper::gather_joints(snapshot.joints);
+            const auto& orientations = KinectWrapper::gather_joints(snapshot.orientations);
+
+            pin_ptr<KinectJointData> pinned = &destination[0];
+            const auto joints = static_cast<KinectJointData*>(pinned);
+            for (auto i = 0; i < count; i++)
+            {
+                const auto& position = positions[i];
+                const auto& orientation = orientations[i].Orientation;
+
+                joints[i].Position = Vector3(position.Position.X, position.Position.Y, position.Position.Z);
+                joints[i].Orientation = Quaternion(orientation.x, orientation.y, orientation.z, orientation.w);
+                joints[i].TrackingState = position.TrackingState;
+                joints[i].JointRole = i;
+            }
+
+            return count;
+        }
+
+
+        // QPC ticks (optionally averaged over a count) as a TimeSpan
+        static TimeSpan QpcTime(const int64_t ticks, const uint64_t count = 1)
+        {
+            return TimeSpan::FromSeconds(count ? qpc_to_seconds(ticks) / static_cast<double>(count) : 0.0);
+        }
+
+        // A sensor or a replay, either one publishes snapshots and previews
+        bool HasFrames()
+        {
+            return kinect_->is_initialized() || kinect_->replaying();
+        }
+
+        // Nothing may unwind back into the updater
+        void OnBodyFrame()
+        {
+            try
+            {
+                BodyFrameHandler();
+            }
+            catch (Exception^)
+            {
+            }
+        }
 
     public:
+        // Every handler owns its wrapper and callback, several may exist at once
         KinectHandler() : kinect_(new KinectWrapper())
         {
+            // Kept alive by the field for as long as the wrapper may call it
             function_ = gcnew FunctionToCallDelegate(this, &KinectHandler::StatusChangedHandler);
-            pin_ptr<FunctionToCallDelegate^> tmp = &function_; // Pin the function delegate
+            kinect_->status_changed(static_cast<void(__cdecl*)()>(
+                Marshal::GetFunctionPointerForDelegate(function_).ToPointer()));
+
+            // Created once, only handed to the wrapper while push mode is on
+            body_frame_function_ = gcnew FunctionToCallDelegate(this, &KinectHandler::OnBodyFrame);
+        }
+
+        // Disposing stops and joins the workers, then frees the wrapper
+        ~KinectHandler()
+        {
+            if (!kinect_) return;
+            kinect_->status_changed(nullptr);
+            kinect_->body_frame_callback(nullptr);
+            kinect_->shutdown();
+
+            // Disposed from one of its own callbacks, the wrapper can't go before the updater does
+            KinectWrapper::destroy(kinect_);
+            kinect_ = nullptr;
+        }
+
+        // Never disposed: no joins on the finalizer thread, live workers are stopped on a pool thread
+        !KinectHandler()
+        {
+            if (!kinect_) return;
+            kinect_->status_changed(nullptr);
+            kinect_->body_frame_callback(nullptr);
 
-            status_changed_event = static_cast<void(__cdecl*)()>(
-                Marshal::GetFunctionPointerForDelegate(function_).ToPointer());
+            KinectWrapper::destroy(kinect_, true);
+            kinect_ = nullptr;
         }
 
         virtual void StatusChangedHandler()
@@ -52,50 +298,275 @@ namespace KinectHandler
             // implemented in the c# handler
         }
 
+        // Push mode: runs on the native updater thread right after a body frame is published
+        virtual void BodyFrameHandler()
+        {
+            // implemented in the c# handler
+        }
+
+        // Calls BodyFrameHandler right after each body frame, from the updater thread
+        property bool IsBodyFrameCallbackEnabled
+        {
+            bool get() { return kinect_->body_frame_callback(); }
+
+            void set(const bool value)
+            {
+                const auto callback = static_cast<void(__cdecl*)()>(
+                    Marshal::GetFunctionPointerForDelegate(body_frame_function_).ToPointer());
+                kinect_->body_frame_callback(value ? callback : nullptr);
+            }
+        }
+
+        // Note: the returned array is reused (overwritten) by the next call
         array<BYTE>^ GetImageBuffer()
         {
-            if (!IsInitialized || !kinect_->camera_enabled()) return __nullptr;
-            const auto& [unmanagedBuffer, size] = kinect_->color_buffer();
-            if (!unmanagedBuffer || size <= 0) return __nullptr;
+            KINECT_TRACE_ZONE("GetImageBuffer");
+            if (!HasFrames() || !kinect_->camera_enabled()) return __nullptr;
+            const auto frame = kinect_->color_frame();
+            if (!frame || frame.size() <= 0) return __nullptr;
+
+            // Managed image placeholder, only reallocated on size changes
+            // (The adaptive camera may hand out half-size frames here, unlike CopyImageBuffer)
+            if (image_buffer_ == nullptr || image_buffer_->Length != static_cast<int>(frame.size()))
+                image_buffer_ = gcnew array<byte>(static_cast<int>(frame.size()));
+
+            Marshal::Copy(IntPtr(const_cast<BYTE*>(frame.data())), image_buffer_, 0, image_buffer_->Length);
+            return image_buffer_; // Return managed array of bytes for our camera image
+        }
 
-            auto data = gcnew array<byte>(size); // Managed image placeholder
-            Marshal::Copy(IntPtr(unmanagedBuffer), data, 0, size);
-            return data; // Return managed array of bytes for our camera image
+        // Copies the camera image into a pinned or native buffer (e.g. a WriteableBitmap)
+        bool CopyImageBuffer(IntPtr destination, const int size)
+        {
+            KINECT_TRACE_ZONE("CopyImageBuffer");
+            if (!HasFrames() || !kinect_->camera_enabled() || size <= 0) return false;
+            return kinect_->copy_color_buffer(static_cast<BYTE*>(destination.ToPointer()), size);
+        }
+
+        // Same as above, but only if there's a frame newer than the passed sequence number
+        // The sequence is updated to the one of the copied frame
+        bool CopyImageBuffer(IntPtr destination, const int size, UInt64% sequence)
+        {
+            KINECT_TRACE_ZONE("CopyImageBuffer");
+            if (!HasFrames() || !kinect_->camera_enabled() || size <= 0) return false;
+
+            uint64_t frameSequence = sequence;
+            if (!kinect_->copy_color_buffer(static_cast<BYTE*>(destination.ToPointer()), size, &frameSequence))
+                return false;
+
+            sequence = frameSequence;
+            return true;
         }
 
         List<KinectJoint^>^ GetTrackedKinectJoints()
         {
-            if (!IsInitialized) return gcnew List<KinectJoint^>;
+            KINECT_TRACE_ZONE("GetTrackedKinectJoints");
+            if (!HasFrames()) return gcnew List<KinectJoint^>;
+            return ToKinectJoints(kinect_->skeleton_snapshot());
+        }
+
+        // Joints extrapolated to a Stopwatch.GetTimestamp() time (if prediction is enabled)
+        List<KinectJoint^>^ GetPredictedKinectJoints(Int64 timestamp)
+        {
+            KINECT_TRACE_ZONE("GetPredictedKinectJoints");
+            if (!HasFrames()) return gcnew List<KinectJoint^>;
+            return ToKinectJoints(kinect_->predicted_snapshot(timestamp));
+        }
+
+        // Joints after the native joint filter, applied once per body frame
+        List<KinectJoint^>^ GetFilteredKinectJoints()
+        {
+            KINECT_TRACE_ZONE("GetFilteredKinectJoints");
+            if (!HasFrames()) return gcnew List<KinectJoint^>;
+            return ToKinectJoints(kinect_->filtered_snapshot());
+        }
 
-            const auto& positions = kinect_->skeleton_positions();
-            const auto& orientations = kinect_->bone_orientations();
+        property JointFilter FilterType
+        {
+            JointFilter get() { return static_cast<JointFilter>(kinect_->joint_filter_settings().type); }
 
-            auto trackedKinectJoints = gcnew List<KinectJoint^>;
-            for each (auto v in Enum::GetValues<TrackedJointType>())
+            void set(const JointFilter value)
             {
-                if (v == TrackedJointType::JointManual)
-                    continue; // Skip unsupported joints
+                auto settings = kinect_->joint_filter_settings();
+                settings.type = static_cast<JointFilterType>(value);
+                kinect_->joint_filter_settings(settings);
+            }
+        }
 
-                auto joint = gcnew KinectJoint(static_cast<int>(v));
+        // One Euro: minimum cutoff frequency (Hz), lower is smoother when still
+        property float FilterMinCutoff
+        {
+            float get() { return kinect_->joint_filter_settings().min_cutoff; }
 
-                joint->TrackingState =
-                    positions[kinect_->KinectJointType(static_cast<int>(v))].TrackingState;
+            void set(const float value)
+            {
+                auto settings = kinect_->joint_filter_settings();
+                settings.min_cutoff = value;
+                kinect_->joint_filter_settings(settings);
+            }
+        }
 
-                joint->Position = Vector3(
-                    positions[kinect_->KinectJointType(static_cast<int>(v))].Position.X,
-                    positions[kinect_->KinectJointType(static_cast<int>(v))].Position.Y,
-                    positions[kinect_->KinectJointType(static_cast<int>(v))].Position.Z);
+        // One Euro: speed coefficient, higher is less laggy when moving
+        property float FilterBeta
+        {
+            float get() { return kinect_->joint_filter_settings().beta; }
 
-                joint->Orientation = Quaternion(
-                    orientations[kinect_->KinectJointType(static_cast<int>(v))].Orientation.x,
-                    orientations[kinect_->KinectJointType(static_cast<int>(v))].Orientation.y,
-                    orientations[kinect_->KinectJointType(static_cast<int>(v))].Orientation.z,
-                    orientations[kinect_->KinectJointType(static_cast<int>(v))].Orientation.w);
+            void set(const float value)
+            {
+                auto settings = kinect_->joint_filter_settings();
+                settings.beta = value;
+                kinect_->joint_filter_settings(settings);
+            }
+        }
 
-                trackedKinectJoints->Add(joint);
+        // Double exponential: value smoothing [0, 1], lower is smoother
+        property float FilterSmoothing
+        {
+            float get() { return kinect_->joint_filter_settings().smoothing; }
+
+            void set(const float value)
+            {
+                auto settings = kinect_->joint_filter_settings();
+                settings.smoothing = value;
+                kinect_->joint_filter_settings(settings);
+            }
+        }
+
+        // Double exponential: trend correction [0, 1]
+        property float FilterCorrection
+        {
+            float get() { return kinect_->joint_filter_settings().correction; }
+
+            void set(const float value)
+            {
+                auto settings = kinect_->joint_filter_settings();
+                settings.correction = value;
+                kinect_->joint_filter_settings(settings);
             }
+        }
 
-            return trackedKinectJoints;
+        // Allocation-free versions of the above, pass a reusable array of 25 joints
+        int CopyTrackedKinectJoints(array<KinectJointData>^ destination)
+        {
+            KINECT_TRACE_ZONE("CopyTrackedKinectJoints");
+            if (!HasFrames()) return 0;
+            return CopyKinectJoints(kinect_->skeleton_snapshot(), destination);
+        }
+
+        int CopyFilteredKinectJoints(array<KinectJointData>^ destination)
+        {
+            KINECT_TRACE_ZONE("CopyFilteredKinectJoints");
+            if (!HasFrames()) return 0;
+            return CopyKinectJoints(kinect_->filtered_snapshot(), destination);
+        }
+
+        int CopyPredictedKinectJoints(array<KinectJointData>^ destination, Int64 timestamp)
+        {
+            KINECT_TRACE_ZONE("CopyPredictedKinectJoints");
+            if (!HasFrames()) return 0;
+            return CopyKinectJoints(kinect_->predicted_snapshot(timestamp), destination);
+        }
+
+        // TrackingIds of every body in the latest frame, returns how many were written
+        int CopyTrackedBodyIds(array<UInt64>^ destination)
+        {
+            if (!HasFrames() || destination == nullptr) return 0;
+
+            const auto& frame = kinect_->body_frame();
+            const auto count = std::min(destination->Length, static_cast<int>(frame.count));
+            for (auto i = 0; i < count; i++)
+                destination[i] = frame.bodies[i].tracking_id;
+
+            return count;
+        }
+
+        // Raw joints of any tracked body, not just the selected one
+        int CopyBodyKinectJoints(UInt64 trackingId, array<KinectJointData>^ destination)
+        {
+            if (!HasFrames()) return 0;
+
+            const auto& frame = kinect_->body_frame();
+            for (size_t i = 0; i < frame.count; i++)
+                if (frame.bodies[i].tracking_id == trackingId)
+                    return CopyKinectJoints(frame.bodies[i], destination, false);
+
+            return 0;
+        }
+
+        property BodySelectionPolicy BodySelection
+        {
+            BodySelectionPolicy get() { return static_cast<BodySelectionPolicy>(kinect_->body_selection()); }
+            void set(const BodySelectionPolicy value) { kinect_->body_selection(static_cast<::BodySelection>(value)); }
+        }
+
+        // The TrackingId to follow with BodySelectionPolicy::Manual
+        property UInt64 SelectedBodyId
+        {
+            UInt64 get() { return kinect_->selected_body_id(); }
+            void set(const UInt64 value) { kinect_->selected_body_id(value); }
+        }
+
+        // The TrackingId the joints currently come from, 0 if nobody's tracked
+        property UInt64 TrackedBodyId
+        {
+            UInt64 get() { return kinect_->skeleton_snapshot().tracking_id; }
+        }
+
+        property bool IsPredictionEnabled
+        {
+            bool get() { return kinect_->prediction_enabled(); }
+            void set(const bool value) { kinect_->prediction_enabled(value); }
+        }
+
+        // Inferred joints are held at the bone lengths learned from tracked frames
+        property bool IsBoneSolverEnabled
+        {
+            bool get() { return kinect_->bone_solver_enabled(); }
+            void set(const bool value) { kinect_->bone_solver_enabled(value); }
+        }
+
+        // Per JointRole; only ankles, feet, wrists and hands can be derived (false for the rest)
+        bool SetJointOrientationSource(const int joint, const JointOrientationSource source)
+        {
+            return kinect_->joint_orientation_mode(static_cast<_JointType>(KinectWrapper::KinectJointType(joint)),
+                                                   static_cast<JointOrientationMode>(source));
+        }
+
+        JointOrientationSource GetJointOrientationSource(const int joint)
+        {
+            return static_cast<JointOrientationSource>(kinect_->joint_orientation_mode(
+                static_cast<_JointType>(KinectWrapper::KinectJointType(joint))));
+        }
+
+        property TimeSpan PredictionHorizon
+        {
+            TimeSpan get() { return TimeSpan::FromSeconds(kinect_->prediction_horizon()); }
+            void set(const TimeSpan value) { kinect_->prediction_horizon(static_cast<float>(value.TotalSeconds)); }
+        }
+
+        // Poses held in the latest body frame (not yet held long enough to fire)
+        property KinectGesture ActiveGestures
+        {
+            KinectGesture get() { return static_cast<KinectGesture>(kinect_->gesture_state().active); }
+        }
+
+        // Gestures that fired since the trigger counts in the caller's array (one per gesture)
+        // The array is updated to the current counts, so the same one can be passed every time
+        KinectGesture PollTriggeredGestures(array<UInt32>^ lastTriggers)
+        {
+            if (!HasFrames() || lastTriggers == nullptr) return KinectGesture::None;
+
+            const auto& state = kinect_->gesture_state();
+            const auto count = std::min(lastTriggers->Length, static_cast<int>(state.triggers.size()));
+
+            auto triggered = KinectGesture::None;
+            for (auto i = 0; i < count; i++)
+            {
+                if (lastTriggers[i] == state.triggers[i]) continue;
+                triggered = triggered | static_cast<KinectGesture>(1 << i);
+                lastTriggers[i] = state.triggers[i];
+            }
+
+            return triggered;
         }
 
         property bool LeftHandClosed
@@ -118,6 +589,182 @@ namespace KinectHandler
             bool get() { return kinect_->skeleton_tracked(); }
         }
 
+        // Incremented with each delivered frame, unchanged means nothing new
+        property UInt64 ColorFrameCount
+        {
+            UInt64 get() { return kinect_->color_frame_count(); }
+        }
+
+        property UInt64 BodyFrameCount
+        {
+            UInt64 get() { return kinect_->body_frame_count(); }
+        }
+
+        property KinectFrameStats Stats
+        {
+            KinectFrameStats get()
+            {
+                const auto& stats = kinect_->frame_stats();
+
+                KinectFrameStats result;
+                result.BodyFrames = stats.body_frames;
+                result.DroppedBodyFrames = stats.dropped_body_frames;
+                result.LateBodyFrames = stats.late_body_frames;
+                result.ColorFrames = stats.color_frames;
+                result.DroppedColorFrames = stats.dropped_color_frames;
+
+                result.BodyDataAge = stats.body_arrival ? QpcTime(qpc_now() - stats.body_arrival) : TimeSpan::Zero;
+                result.MeanBodyProcessing = QpcTime(stats.body_processing_ticks, stats.body_frames);
+                result.MaxBodyProcessing = QpcTime(stats.body_processing_max);
+                result.MeanColorProcessing = QpcTime(stats.color_processing_ticks, stats.color_frames);
+                result.MaxColorProcessing = QpcTime(stats.color_processing_max);
+
+                result.Reads = stats.reads;
+                result.MeanReadLatency = QpcTime(stats.read_latency_ticks, stats.reads);
+                result.ReadLatencyHistogram = gcnew array<UInt64>(static_cast<int>(stats.read_latency.size()));
+                for (auto i = 0; i < result.ReadLatencyHistogram->Length; i++)
+                    result.ReadLatencyHistogram[i] = stats.read_latency[i];
+
+                const auto& connection = kinect_->connection_stats();
+                result.Stalls = connection.stalls;
+                result.LastStall = QpcTime(connection.last_stall);
+                result.LongestStall = QpcTime(connection.longest_stall);
+                result.TotalStall = QpcTime(connection.total_stall);
+
+                const auto& schedule = kinect_->updater_schedule();
+                result.UpdaterMmcssTask = static_cast<KinectMmcssTask>(schedule.mmcss_task);
+                result.UpdaterPriority = schedule.priority;
+                result.UpdaterAffinity = schedule.affinity;
+
+                const auto& throttle = kinect_->color_throttle_stats();
+                result.ColorThrottleLevel = throttle.level;
+                result.ColorFrameRateCap = throttle.fps_cap;
+                result.ConsumerColorFrameRate = throttle.consumer_fps;
+                result.ColorThrottleScale = throttle.scale;
+                result.ThrottledColorFrames = throttle.throttled;
+                result.IsColorPaused = throttle.paused;
+
+                return result;
+            }
+        }
+
+        // Writes body frames (and halved camera frames) to path and path.idx
+        bool StartRecording(String^ path, const bool withColor)
+        {
+            if (String::IsNullOrEmpty(path)) return false;
+            const pin_ptr<const wchar_t> chars = PtrToStringChars(path);
+            return kinect_->start_recording(chars, withColor);
+        }
+
+        void StopRecording()
+        {
+            kinect_->stop_recording();
+        }
+
+        property bool IsRecording
+        {
+            bool get() { return kinect_->recording(); }
+        }
+
+        // Shares every body frame (and optionally the camera preview) with other processes
+        // through a named memory mapping, e.g. "Local\\K2VR.KinectOne"; see SharedExport.h
+        // The sensor id is appended (SharedExportName), fails if that mapping already exists
+        bool StartSharedExport(String^ name, const bool withColor)
+        {
+            if (String::IsNullOrEmpty(name)) return false;
+            const pin_ptr<const wchar_t> chars = PtrToStringChars(name);
+            return kinect_->start_export(chars, withColor);
+        }
+
+        void StopSharedExport()
+        {
+            kinect_->stop_export();
+        }
+
+        property bool IsSharedExportEnabled
+        {
+            bool get() { return kinect_->exporting(); }
+        }
+
+        // What readers should open, null while not exporting
+        property String^ SharedExportName
+        {
+            String^ get()
+            {
+                const auto name = kinect_->export_name();
+                return name.empty() ? __nullptr : gcnew String(name.c_str());
+            }
+        }
+
+        // Feeds a recording through the pipeline in place of the sensor
+        // With realtime off, frames are pushed as fast as they're processed
+        bool StartReplay(String^ path, const bool realtime)
+        {
+            if (String::IsNullOrEmpty(path)) return false;
+            const pin_ptr<const wchar_t> chars = PtrToStringChars(path);
+            return kinect_->start_replay(chars, realtime);
+        }
+
+        void StopReplay()
+        {
+            kinect_->stop_replay();
+        }
+
+        property bool IsReplaying
+        {
+            bool get() { return kinect_->replaying(); }
+        }
+
+        // Register the updater thread with MMCSS, the most direct fix for late body frames
+        property KinectMmcssTask UpdaterMmcssTask
+        {
+            KinectMmcssTask get() { return static_cast<KinectMmcssTask>(kinect_->updater_thread_settings().mmcss_task); }
+
+            void set(const KinectMmcssTask value)
+            {
+                auto settings = kinect_->updater_thread_settings();
+                settings.mmcss_task = static_cast<MmcssTask>(value);
+                kinect_->updater_thread_settings(settings);
+            }
+        }
+
+        // With MMCSS on, only TimeCritical changes anything (critical vs high)
+        property KinectThreadPriority UpdaterPriority
+        {
+            KinectThreadPriority get() { return static_cast<KinectThreadPriority>(kinect_->updater_thread_settings().priority); }
+
+            void set(const KinectThreadPriority value)
+            {
+                auto settings = kinect_->updater_thread_settings();
+                settings.priority = static_cast<SchedulePriority>(value);
+                kinect_->updater_thread_settings(settings);
+            }
+        }
+
+        // Cores the updater may run on, 0 for any
+        property UInt64 UpdaterAffinityMask
+        {
+            UInt64 get() { return kinect_->updater_thread_settings().affinity; }
+
+            void set(const UInt64 value)
+            {
+                auto settings = kinect_->updater_thread_settings();
+                settings.affinity = value;
+                kinect_->updater_thread_settings(settings);
+            }
+        }
+
+        property KinectConnectionState ConnectionState
+        {
+            KinectConnectionState get() { return static_cast<KinectConnectionState>(kinect_->connection_state()); }
+        }
+
+        // How long the current stall has lasted, zero unless Stalled
+        property TimeSpan StallDuration
+        {
+            TimeSpan get() { return QpcTime(kinect_->connection_stats().current_stall); }
+        }
+
         property int DeviceStatus
         {
             int get() { return kinect_->status_result(); }
@@ -134,6 +781,89 @@ namespace KinectHandler
             bool get() { return DeviceStatus == 0; }
         }
 
+        // Changing this resizes the camera image (CameraImageWidth/Height)
+        property CameraPreviewMode PreviewMode
+        {
+            CameraPreviewMode get() { return static_cast<CameraPreviewMode>(kinect_->preview_mode()); }
+            void set(const CameraPreviewMode value) { kinect_->preview_mode(static_cast<KinectWrapper::PreviewMode>(value)); }
+        }
+
+        // Zoom the scaled preview in on the tracked body
+        property bool IsPreviewCropped
+        {
+            bool get() { return kinect_->preview_cropped(); }
+            void set(const bool value) { kinect_->preview_cropped(value); }
+        }
+
+        // Read body and color frames independently, so color never delays poses
+        // (Applied on the next InitializeKinect call)
+        property bool IsSplitReaderModeEnabled
+        {
+            bool get() { return kinect_->split_readers(); }
+            void set(const bool value) { kinect_->split_readers(value); }
+        }
+
+        // Convert the camera's raw YUY2 frames natively, on a separate thread
+        property bool IsRawColorConversionEnabled
+        {
+            bool get() { return kinect_->raw_color_conversion(); }
+            void set(const bool value) { kinect_->raw_color_conversion(value); }
+        }
+
+        // Throttle the camera to keep body frames in budget: lower rate, then smaller previews,
+        // only a probe now and then while hidden or unread. CopyImageBuffer scales the smaller
+        // previews back up, so CameraImageWidth/Height stay as the preview mode sets them
+        property bool IsAdaptiveCameraEnabled
+        {
+            bool get() { return kinect_->color_throttle_settings().adaptive; }
+
+            void set(const bool value)
+            {
+                auto settings = kinect_->color_throttle_settings();
+                settings.adaptive = value;
+                kinect_->color_throttle_settings(settings);
+            }
+        }
+
+        // Adaptive mode only, the most camera frames converted per second
+        property float CameraFrameRateCap
+        {
+            float get() { return kinect_->color_throttle_settings().max_fps; }
+
+            void set(const float value)
+            {
+                auto settings = kinect_->color_throttle_settings();
+                settings.max_fps = std::clamp(value, 1.0f, 30.0f);
+                kinect_->color_throttle_settings(settings);
+            }
+        }
+
+        // Adaptive mode only, body frame processing time the camera may not push past
+        property TimeSpan CameraBodyBudget
+        {
+            TimeSpan get() { return TimeSpan::FromSeconds(kinect_->color_throttle_settings().body_budget); }
+
+            void set(const TimeSpan value)
+            {
+                auto settings = kinect_->color_throttle_settings();
+                settings.body_budget = static_cast<float>(value.TotalSeconds);
+                kinect_->color_throttle_settings(settings);
+            }
+        }
+
+        // Adaptive mode only, set by whoever knows whether the preview is on screen
+        property bool IsCameraPreviewVisible
+        {
+            bool get() { return kinect_->color_throttle_settings().preview_visible; }
+
+            void set(const bool value)
+            {
+                auto settings = kinect_->color_throttle_settings();
+                settings.preview_visible = value;
+                kinect_->color_throttle_settings(settings);
+            }
+        }
+
         property int CameraImageWidth
         {
             int get() { return kinect_->CameraImageSize().first; }
@@ -144,15 +874,125 @@ namespace KinectHandler
             int get() { return kinect_->CameraImageSize().second; }
         }
 
+        // Opt-in 16-bit streams, their readers only run while enabled
+        property bool IsDepthEnabled
+        {
+            bool get() { return kinect_->depth_enabled(); }
+            void set(const bool value) { kinect_->depth_enabled(value); }
+        }
+
+        property bool IsInfraredEnabled
+        {
+            bool get() { return kinect_->infrared_enabled(); }
+            void set(const bool value) { kinect_->infrared_enabled(value); }
+        }
+
+        property UInt64 DepthFrameCount
+        {
+            UInt64 get() { return kinect_->depth_frame_count(); }
+        }
+
+        property UInt64 InfraredFrameCount
+        {
+            UInt64 get() { return kinect_->infrared_frame_count(); }
+        }
+
+        // Same for depth and infrared: 512x424, 2 bytes per pixel
+        property int DepthImageWidth
+        {
+            int get() { return kinect_->DepthFrameSize().first; }
+        }
+
+        property int DepthImageHeight
+        {
+            int get() { return kinect_->DepthFrameSize().second; }
+        }
+
+        // Depth in millimeters, only if there's a frame newer than the given sequence
+        bool CopyDepthBuffer(IntPtr destination, const int size, UInt64% sequence)
+        {
+            if (!HasFrames() || size <= 0) return false;
+
+            uint64_t frameSequence = sequence;
+            if (!kinect_->copy_depth_buffer(static_cast<BYTE*>(destination.ToPointer()), size, &frameSequence))
+                return false;
+
+            sequence = frameSequence;
+            return true;
+        }
+
+        bool CopyInfraredBuffer(IntPtr destination, const int size, UInt64% sequence)
+        {
+            if (!HasFrames() || size <= 0) return false;
+
+            uint64_t frameSequence = sequence;
+            if (!kinect_->copy_infrared_buffer(static_cast<BYTE*>(destination.ToPointer()), size, &frameSequence))
+                return false;
+
+            sequence = frameSequence;
+            return true;
+        }
+
         Drawing::Size MapCoordinate(Vector3 position)
         {
-            if (!IsInitialized) return Drawing::Size::Empty;
+            if (!HasFrames()) return Drawing::Size::Empty;
             const auto& [width, height] =
                 kinect_->MapCoordinate(CameraSpacePoint{position.X, position.Y, position.Z});
 
             return Drawing::Size(width, height);
         }
 
+        // Maps a whole batch of points at once, returns how many were written
+        int MapCoordinates(array<Vector3>^ positions, array<Drawing::Size>^ destination)
+        {
+            if (!HasFrames() || positions == nullptr || destination == nullptr) return 0;
+
+            const auto count = std::min(positions->Length, destination->Length);
+            if (count <= 0) return 0;
+
+            // Vector3 and Size match CameraSpacePoint and an x/y int pair
+            pin_ptr<Vector3> source = &positions[0];
+            pin_ptr<Drawing::Size> coordinates = &destination[0];
+            kinect_->map_coordinates(reinterpret_cast<const CameraSpacePoint*>(static_cast<Vector3*>(source)),
+                                     count, reinterpret_cast<int*>(static_cast<Drawing::Size*>(coordinates)));
+
+            return count;
+        }
+
+        // Preview coordinates of all joints, pre-mapped with the body frame
+        // Needs IsJointMappingEnabled, otherwise nothing is written
+        int CopyJointCoordinates(array<Drawing::Size>^ destination, bool filtered)
+        {
+            if (!HasFrames() || !kinect_->joint_mapping_enabled() || destination == nullptr) return 0;
+
+            const auto& snapshot = filtered ? kinect_->filtered_snapshot() : kinect_->skeleton_snapshot();
+            const auto& points = KinectWrapper::gather_joints(snapshot.color_points);
+
+            const auto count = std::min(destination->Length, static_cast<int>(points.size()));
+            for (auto i = 0; i < count; i++)
+            {
+                const auto& [x, y] = kinect_->preview_coordinate(points[i]);
+                destination[i] = Drawing::Size(x, y);
+            }
+
+            return count;
+        }
+
+        property bool IsJointMappingEnabled
+        {
+            bool get() { return kinect_->joint_mapping_enabled(); }
+            void set(const bool value) { kinect_->joint_mapping_enabled(value); }
+        }
+
+        // Draw the tracked skeleton into the camera image natively, instead of on top of it
+        property bool IsSkeletonOverlayEnabled
+        {
+            bool get() { return kinect_->overlay_enabled(); }
+            void set(const bool value) { kinect_->overlay_enabled(value); }
+        }
+
+        // Returns right away and may be called again, the opened sensor is reused
+        // StatusChangedHandler runs once it actually becomes available
         int InitializeKinect()
         {
             return kinect_->initialize();
@@ -5,14 +5,38 @@
 #include <atlbase.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cwctype>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <utility>
 #include <array>
-#include <map>
+#include <atomic>
 #include <functional>
 
-inline void (*status_changed_event)();
+#include "BodyTracking.h"
+#include "BoneSolver.h"
+#include "ColorConversion.h"
+#include "ColorThrottle.h"
+#include "Connection.h"
+#include "FramePool.h"
+#include "FrameStats.h"
+#include "FrameStream.h"
+#include "Gestures.h"
+#include "JointFilters.h"
+#include "JointPrediction.h"
+#include "OrientationFixups.h"
+#include "Overlay.h"
+#include "Recording.h"
+#include "SharedExport.h"
+#include "SkeletonSnapshot.h"
+#include "ThreadScheduling.h"
+#include "Timing.h"
+#include "Tracing.h"
 
 class KinectWrapper
 {
@@ -22,33 +46,220 @@ class KinectWrapper
     ICoordinateMapper* coordMapper = nullptr;
     BOOLEAN isTracking = false;
 
-    Joint joints[JointType_Count];
-    JointOrientation boneOrientations[JointType_Count];
     IBody* kinectBodies[BODY_COUNT] = {nullptr};
 
-    HandState leftHandState = HandState_Unknown;
-    HandState rightHandState = HandState_Unknown;
+    WAITABLE_HANDLE h_statusChangedEvent = NULL;
+    WAITABLE_HANDLE h_multiFrameEvent = NULL;
+
+    // Split mode: independent body and (on-demand) color readers
+    IBodyFrameReader* bodyFrameReader = nullptr;
+    IColorFrameReader* colorFrameReader = nullptr;
+    WAITABLE_HANDLE h_bodyFrameEvent = NULL;
+    WAITABLE_HANDLE h_colorFrameEvent = NULL;
+    std::unique_ptr<std::thread> color_thread_;
+    bool split_readers_ = false; // What's open now
+    bool split_readers_requested_ = false; // What the next initialize() opens
+
+    // Written only by the updater, published as a whole to readers
+    SkeletonSnapshot pending_snapshot_;
+    SeqLocked<SkeletonSnapshot> skeleton_snapshot_;
+    std::atomic<uint64_t> body_frame_count_{0};
+
+    // All tracked bodies, and which one of them the snapshot follows
+    BodyFrame pending_bodies_;
+    SeqLocked<BodyFrame> body_frame_;
+    BodySelector selector_;
+    std::atomic<BodySelection> body_selection_{BodySelection::LockFirst};
+    std::atomic<UINT64> manual_body_id_{0};
+
+    // The followed user's bone lengths, held for joints the sensor only inferred
+    BoneSolver bones_;
+    std::atomic<bool> bone_solver_enabled_{false};
+
+    // Ankle, foot, wrist and hand orientations rebuilt from positions, a bit per JointType
+    OrientationFixups orientation_fixups_;
+    std::atomic<uint32_t> derived_orientations_{0};
+
+    // Smoothed copy of every frame, published next to the raw one
+    JointFilterBank filters_;
+    SeqLocked<JointFilterSettings> filter_settings_;
+    SkeletonSnapshot filtered_pending_;
+    SeqLocked<SkeletonSnapshot> filtered_snapshot_;
+
+    // Pause/point poses of the followed user, evaluated on the filtered joints
+    GestureStage gestures_;
+    SeqLocked<GestureState> gesture_state_;
+
+    // Velocities derived from the last few frames, for extrapolation by readers
+    JointPredictor predictor_;
+    SeqLocked<PredictionModel> prediction_model_;
+    std::atomic<bool> prediction_enabled_{false};
+    std::atomic<float> prediction_horizon_{0.0f};
+
+    // Converted camera frames, leased out to readers without copying
+    FramePool<3> color_frames_;
+
+    // Timings and drop counters from all workers
+    FrameStats stats_;
+    std::atomic<uint64_t> consumed_sequence_{0}; // Last body frame counted by mark_consumed
+
+    // Short drops are ridden out as stalls, only longer ones are reported
+    ConnectionMonitor connection_;
+
+    // Captures: the recorder has its own writer, replays run on the updater
+    FrameRecorder recorder_;
+    FrameReplay replay_;
+    std::atomic<bool> replaying_{false}, replay_stop_{false};
+    std::atomic<bool> replay_color_{false}; // Handed the color pool by start_replay
+    bool replay_realtime_ = true;
+    int64_t replay_start_ = 0; // QPC, when the first record was due
+    std::pair<int, int> replay_image_size_{0, 0};
+
+    // Optional named shared-memory copy of every frame, for other processes
+    // Writers hold a use count while publishing, so it can be swapped out under them
+    std::atomic<SharedExport*> export_{nullptr};
+    std::atomic<int> export_users_{0};
+    std::wstring export_name_; // Only touched by whoever starts the export
+
+    // Opt-in 16-bit streams, with readers of their own on a background thread
+    DepthStream depth_stream_;
+    InfraredStream infrared_stream_;
+    std::unique_ptr<std::thread> stream_thread_;
 
-    WAITABLE_HANDLE h_statusChangedEvent;
-    WAITABLE_HANDLE h_multiFrameEvent;
+    std::unique_ptr<std::thread> updater_thread_;
 
-    std::array<JointOrientation, JointType_Count> bone_orientations_;
-    std::array<Joint, JointType_Count> skeleton_positions_;
+    // shutdown() called back on the updater runs here instead, the updater can't join itself
+    std::unique_ptr<std::thread> shutdown_thread_;
+    std::mutex shutdown_lock_;
 
-    std::unique_ptr<std::thread> updater_thread_;
+    // MMCSS, priority and affinity of the updater, re-applied whenever they're changed
+    SeqLocked<ThreadSettings> thread_settings_;
+    std::atomic<uint64_t> thread_settings_version_{0};
+    SeqLocked<ThreadSchedule> updater_schedule_;
+
+    // Manual-reset: stops all workers; auto-reset: re-read the wait handles
+    HANDLE h_shutdownEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    HANDLE h_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    HANDLE h_colorWakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    HANDLE h_streamWakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    HANDLE h_replayClosedEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr); // Manual-reset, see stop_replay
+
+    // Everything is per instance, any number of wrappers may live side by side
+    std::atomic<bool> initialized_{false};
 
-    inline static bool initialized_ = false;
-    bool skeleton_tracked_ = false;
+    // Called on the updater thread when availability is reported, the pointer carries its own context
+    // (e.g. a delegate bound to the owning handler)
+    std::atomic<void (*)()> status_changed_{nullptr};
+
+    // Called on the updater thread right after each body frame is published, if set
+    std::atomic<void (*)()> body_frame_callback_{nullptr};
     bool rgb_stream_enabled_ = false;
 
     void updater()
     {
+        ThreadScheduler scheduler;
+        auto applied = ~0ull;
+
         // Auto-handles failures & etc
-        while (true)update();
+        do
+        {
+            if (const auto version = thread_settings_version_.load(); version != applied)
+            {
+                // Pose latency matters most when body frames have their own reader
+                applied = version;
+                updater_schedule_.store(scheduler.apply(thread_settings_.load(), split_readers_));
+            }
+        }
+        while (update());
+    }
+
+    void updateStatus()
+    {
+        tryCef([&, this]
+        {
+            CComPtr<IIsAvailableChangedEventArgs> args;
+            if (kinectSensor->GetIsAvailableChangedEventData(h_statusChangedEvent, &args) == S_OK)
+            {
+                BOOLEAN isAvailable = false;
+                args->get_IsAvailable(&isAvailable);
+
+#ifdef _DEBUG
+                // Emulation support bypass
+                isAvailable = true;
+#endif
+
+                // A drop of a streaming sensor waits for checkConnection()
+                if (connection_.availability(isAvailable, qpc_now()) || isAvailable)
+                    reportAvailable(isAvailable);
+            }
+        });
+    }
+
+    // Runs when a wait times out, a stall that outlived a glitch becomes a disconnect
+    void checkConnection()
+    {
+        if (connection_.check(qpc_now())) reportAvailable(false);
+    }
+
+    void reportAvailable(const bool available)
+    {
+        if (initialized_ == available) return;
+        initialized_ = available; // Update the status
+        if (const auto callback = status_changed_.load()) callback(); // Notify the CLR listener
+    }
+
+    void updateFrame()
+    {
+        tryCef([&, this]
+        {
+            if (split_readers_)
+            {
+                CComPtr<IBodyFrameArrivedEventArgs> args;
+                if (bodyFrameReader &&
+                    SUCCEEDED(bodyFrameReader->GetFrameArrivedEventData(h_bodyFrameEvent, &args)))
+                    updateBodyFrameData(args);
+            }
+            else
+            {
+                CComPtr<IMultiSourceFrameArrivedEventArgs> args;
+                if (multiFrameReader &&
+                    SUCCEEDED(multiFrameReader->GetMultiSourceFrameArrivedEventData(h_multiFrameEvent, &args)))
+                    updateFrameData(args);
+            }
+        });
+    }
+
+    // Signal every worker to exit and wait for them
+    // Never from a worker itself, shutdown() hands that off to shutdown_thread_
+    void stopThreads()
+    {
+        SetEvent(h_shutdownEvent);
+        for (const auto thread : {&updater_thread_, &color_thread_, &converter_thread_, &stream_thread_})
+        {
+            if (!*thread) continue;
+            if ((*thread)->joinable()) (*thread)->join();
+            thread->reset();
+        }
+
+        raw_color_pending_ = false;
+
+        // Nothing plays without the updater
+        closeReplay();
+        replay_stop_ = false;
+    }
+
+    // Whoever owns the replay (the updater, or nobody once it's gone), stop_replay waits for this
+    void closeReplay()
+    {
+        replay_.close();
+        replay_color_ = false;
+        replaying_ = false;
+        SetEvent(h_replayClosedEvent);
     }
 
     void updateFrameData(IMultiSourceFrameArrivedEventArgs* args)
     {
+        KINECT_TRACE_ZONE("updateFrameData");
         if (!multiFrameReader) return; // Give up already
 
         // Acquire the multi-source frame reference
@@ -68,110 +279,617 @@ class KinectWrapper
         bodyFrameReference->AcquireFrame(&bodyFrame);
 
         if (!bodyFrame) return;
-        bodyFrame->GetAndRefreshBodyData(BODY_COUNT, kinectBodies);
-        if (bodyFrame) bodyFrame->Release();
+        processBodyFrame(bodyFrame);
+        bodyFrame->Release();
+
+        // Don't process color if not requested
+        if (!camera_enabled()) return;
+
+        // Get the color frame and process it
+        IColorFrameReference* colorFrameReference = nullptr;
+        multiFrame->get_ColorFrameReference(&colorFrameReference);
+
+        IColorFrame* colorFrame = nullptr;
+        colorFrameReference->AcquireFrame(&colorFrame);
+
+        if (!colorFrame) return;
+
+        processColorFrame(colorFrame);
+        colorFrame->Release();
+    }
+
+    void updateBodyFrameData(IBodyFrameArrivedEventArgs* args)
+    {
+        KINECT_TRACE_ZONE("updateBodyFrameData");
+        if (!bodyFrameReader) return; // Give up already
 
-        // We have the frame, now parse it
+        CComPtr<IBodyFrameReference> frameReference;
+        args->get_FrameReference(&frameReference);
+        if (!frameReference) return;
+
+        CComPtr<IBodyFrame> bodyFrame;
+        frameReference->AcquireFrame(&bodyFrame);
+        if (bodyFrame) processBodyFrame(bodyFrame);
+    }
+
+    void processBodyFrame(IBodyFrame* bodyFrame)
+    {
+        const auto arrival = qpc_now();
+        connection_.frame(arrival);
+        {
+            KINECT_TRACE_ZONE("GetAndRefreshBodyData");
+            bodyFrame->GetAndRefreshBodyData(BODY_COUNT, kinectBodies);
+        }
+        bodyFrame->get_RelativeTime(&pending_snapshot_.timestamp);
+
+        // Pack every tracked body, straight into the preallocated frame
+        pending_bodies_.count = 0;
         for (const auto& i : kinectBodies)
         {
             BOOLEAN isSkeletonTracked = false;
             if (i)i->get_IsTracked(&isSkeletonTracked);
+            if (!isSkeletonTracked) continue;
+
+            auto& body = pending_bodies_.bodies[pending_bodies_.count++];
+            body.tracked = true;
+            body.timestamp = pending_snapshot_.timestamp;
+            i->get_TrackingId(&body.tracking_id);
+
+            // Copy joint positions & orientations
+            i->GetJoints(JointType_Count, body.joints.data());
+            i->GetJointOrientations(JointType_Count, body.orientations.data());
+
+            // Get hand states
+            i->get_HandLeftState(&body.left_hand_state);
+            i->get_HandRightState(&body.right_hand_state);
+        }
+
+        publishBodyFrame(arrival);
+    }
+
+    // Everything after the sensor: selection, filters, prediction and publishing
+    // Expects pending_bodies_ and pending_snapshot_.timestamp to be filled in
+    void publishBodyFrame(const int64_t arrival)
+    {
+        const auto previousId = selector_.locked_id();
+        const auto selected = selector_.select(
+            pending_bodies_, body_selection_.load(std::memory_order_relaxed),
+            manual_body_id_.load(std::memory_order_relaxed));
+
+        if (selected >= 0)
+        {
+            const auto& body = pending_bodies_.bodies[selected];
+            pending_snapshot_.joints = body.joints;
+            pending_snapshot_.orientations = body.orientations;
+            pending_snapshot_.left_hand_state = body.left_hand_state;
+            pending_snapshot_.right_hand_state = body.right_hand_state;
+        }
+        else
+        {
+            pending_snapshot_.left_hand_state = HandState_Unknown;
+            pending_snapshot_.right_hand_state = HandState_Unknown;
+        }
+
+        pending_snapshot_.tracked = selected >= 0;
+        pending_snapshot_.tracking_id = selector_.locked_id();
+
+        // Don't filter or extrapolate across two different people
+        if (previousId != 0 && selector_.locked_id() != previousId)
+        {
+            predictor_.reset();
+            filters_.reset();
+            orientation_fixups_.reset();
+        }
+
+        if (pending_snapshot_.tracked && bone_solver_enabled_.load(std::memory_order_relaxed))
+        {
+            KINECT_TRACE_ZONE("bone solver");
+            bones_.solve(pending_snapshot_);
+        }
+
+        if (const auto derived = derived_orientations_.load(std::memory_order_relaxed);
+            derived && pending_snapshot_.tracked)
+        {
+            KINECT_TRACE_ZONE("orientation fixups");
+            orientation_fixups_.apply(pending_snapshot_, derived);
+        }
+
+        // Publish the whole frame at once (untracked frames keep the last pose)
+        pending_snapshot_.sequence++;
+        pending_snapshot_.arrival = arrival;
+        for (size_t i = 0; i < pending_bodies_.count; i++)
+        {
+            pending_bodies_.bodies[i].sequence = pending_snapshot_.sequence;
+            pending_bodies_.bodies[i].arrival = pending_snapshot_.arrival;
+        }
+
+        pending_bodies_.sequence = pending_snapshot_.sequence;
+        body_frame_.store(pending_bodies_);
+        recorder_.push(pending_bodies_, pending_snapshot_.timestamp);
+
+        filters_.apply(pending_snapshot_, filtered_pending_, filter_settings_.load());
+        if (joint_mapping_enabled_.load(std::memory_order_relaxed)) mapSnapshotJoints();
+
+        skeleton_snapshot_.store(pending_snapshot_);
+        prediction_model_.store(predictor_.push(pending_snapshot_));
+        filtered_snapshot_.store(filtered_pending_);
+        withExport([this](SharedExport& shared)
+        {
+            shared.publish(pending_snapshot_, filtered_pending_, pending_bodies_.count);
+        });
+        gesture_state_.store(gestures_.push(filtered_pending_));
+        body_frame_count_.store(pending_snapshot_.sequence, std::memory_order_release);
+        stats_.body_frame(pending_snapshot_.timestamp, arrival, qpc_now());
+
+        // Push mode: everything above is readable by now
+        if (const auto callback = body_frame_callback_.load(std::memory_order_acquire))
+        {
+            KINECT_TRACE_ZONE("body frame callback");
+            callback();
+        }
+    }
+
+    // Milliseconds until the next replayed record is due, 0 when not keeping time
+    DWORD replayTimeout() const
+    {
+        const auto entry = replay_.peek();
+        if (!entry || !replay_realtime_) return 0;
+
+        const auto due = replay_start_ + seconds_to_qpc(
+            static_cast<double>(entry->timestamp - replay_.first_timestamp()) / 1e7);
+        return static_cast<DWORD>(std::max(qpc_to_seconds(due - qpc_now()) * 1000.0, 0.0));
+    }
+
+    // Feed every due record through the usual pipeline, one at a time when not keeping time
+    void replayFrames()
+    {
+        while (const auto entry = replay_.peek())
+        {
+            if (replay_realtime_ && replayTimeout() > 0) return;
+
+            if (entry->type == recording::RecordType::Body && replay_.read_bodies(*entry, pending_bodies_))
+            {
+                pending_snapshot_.timestamp = entry->timestamp;
+                publishBodyFrame(qpc_now());
+            }
+            else if (entry->type == recording::RecordType::Color) replayColorFrame(*entry);
+
+            replay_.advance();
+            if (!replay_realtime_) return; // Re-check the handles between frames
+        }
+
+        // Played to the end
+        closeReplay();
+    }
+
+    void replayColorFrame(const recording::IndexEntry& entry)
+    {
+        recording::ColorRecord info{};
+        const auto pixels = replay_.read_color(entry, info);
+        if (!pixels || raw_color_pending_ || !replay_color_) return;
+
+        const auto size = static_cast<size_t>(info.width) * info.height * 4;
+        const auto buffer = color_frames_.begin_write(size);
+        if (!buffer) return; // All slots are leased, drop this one
+
+        std::memcpy(buffer, pixels, size);
+        drawOverlay(buffer, info.width, info.height, info.factor, info.origin_x, info.origin_y);
+        preview_factor_ = info.factor;
+        preview_upscale_ = 1;
+        preview_origin_x_ = info.origin_x;
+        preview_origin_y_ = info.origin_y;
+        replay_image_size_ = std::make_pair(info.width, info.height);
+        color_frames_.commit_write();
+        exportColorFrame();
+    }
+
+    // Raw and filtered joints to color space in a single mapper call
+    void mapSnapshotJoints()
+    {
+        if (!coordMapper) return;
+
+        std::array<CameraSpacePoint, JointType_Count * 2> points;
+        std::array<ColorSpacePoint, JointType_Count * 2> mapped;
+        for (size_t i = 0; i < JointType_Count; i++)
+        {
+            points[i] = pending_snapshot_.joints[i].Position;
+            points[JointType_Count + i] = filtered_pending_.joints[i].Position;
+        }
+
+        if (FAILED(coordMapper->MapCameraPointsToColorSpace(
+            static_cast<UINT>(points.size()), points.data(), static_cast<UINT>(mapped.size()), mapped.data())))
+            mapped.fill(ColorSpacePoint{-INFINITY, -INFINITY});
+
+        std::copy_n(mapped.begin(), JointType_Count, pending_snapshot_.color_points.begin());
+        std::copy_n(mapped.begin() + JointType_Count, JointType_Count, filtered_pending_.color_points.begin());
+    }
+
+    // Split mode: a lower-priority thread owning the color reader
+    void colorUpdater()
+    {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+        while (true)
+        {
+            // Only keep the color reader open while someone wants the camera
+            const auto wanted = split_readers_ && camera_enabled() && kinectSensor;
+            if (!wanted) terminateColorReader();
+            else if (!colorFrameReader) initializeColorReader();
+
+            HANDLE handles[3] = {h_shutdownEvent, h_colorWakeEvent};
+            DWORD count = 2;
+            if (colorFrameReader && h_colorFrameEvent)
+                handles[count++] = reinterpret_cast<HANDLE>(h_colorFrameEvent);
+
+            // Retry periodically if the reader couldn't be opened yet
+            const auto result = WaitForMultipleObjects(
+                count, handles, FALSE, wanted && !colorFrameReader ? 500 : INFINITE);
+
+            if (result == WAIT_OBJECT_0) break; // Shutting down
+            if (result != WAIT_OBJECT_0 + 2) continue; // Woken up or timed out
+
+            tryCef([&, this]
+            {
+                CComPtr<IColorFrameArrivedEventArgs> args;
+                if (FAILED(colorFrameReader->GetFrameArrivedEventData(h_colorFrameEvent, &args)) || !args)
+                    return;
+
+                CComPtr<IColorFrameReference> frameReference;
+                args->get_FrameReference(&frameReference);
+                if (!frameReference) return;
+
+                CComPtr<IColorFrame> colorFrame;
+                frameReference->AcquireFrame(&colorFrame);
+                if (colorFrame) processColorFrame(colorFrame);
+            });
+        }
+
+        terminateColorReader();
+    }
+
+    // Depth and infrared readers, opened only while a consumer wants them
+    void streamUpdater()
+    {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+        while (true)
+        {
+            refreshStream(depth_stream_, [this]
+            {
+                CComPtr<IDepthFrameSource> source;
+                kinectSensor->get_DepthFrameSource(&source);
+                return source;
+            });
+            refreshStream(infrared_stream_, [this]
+            {
+                CComPtr<IInfraredFrameSource> source;
+                kinectSensor->get_InfraredFrameSource(&source);
+                return source;
+            });
+
+            HANDLE handles[4] = {h_shutdownEvent, h_streamWakeEvent};
+            DWORD count = 2, depthIndex = MAXDWORD, infraredIndex = MAXDWORD;
+            if (const auto handle = depth_stream_.wait_handle())
+            {
+                depthIndex = count;
+                handles[count++] = handle;
+            }
+            if (const auto handle = infrared_stream_.wait_handle())
+            {
+                infraredIndex = count;
+                handles[count++] = handle;
+            }
 
-            if (isSkeletonTracked)
+            // Retry periodically if a wanted reader couldn't be opened yet
+            const auto pending = (depth_stream_.enabled() && !depth_stream_.is_open()) ||
+                (infrared_stream_.enabled() && !infrared_stream_.is_open());
+
+            const auto result = WaitForMultipleObjects(count, handles, FALSE, pending ? 500 : INFINITE);
+            if (result == WAIT_OBJECT_0) break; // Shutting down
+
+            tryCef([&, this]
             {
-                skeleton_tracked_ = isSkeletonTracked;
-                i->GetJoints(JointType_Count, joints);
-                i->GetJointOrientations(JointType_Count, boneOrientations);
+                if (result == WAIT_OBJECT_0 + depthIndex) depth_stream_.read();
+                else if (result == WAIT_OBJECT_0 + infraredIndex) infrared_stream_.read();
+            });
+        }
+
+        depth_stream_.close();
+        infrared_stream_.close();
+    }
+
+    template <typename Stream, typename GetSource>
+    void refreshStream(Stream& stream, const GetSource& getSource)
+    {
+        if (!stream.enabled() || !kinectSensor) stream.close();
+        else if (!stream.is_open()) stream.open(getSource());
+    }
 
-                // Copy joint positions & orientations
-                std::copy(std::begin(joints), std::end(joints),
-                          skeleton_positions_.begin());
-                std::copy(std::begin(boneOrientations), std::end(boneOrientations),
-                          bone_orientations_.begin());
+    // Started with the first stream request, exits with the other workers
+    void startStreamThread()
+    {
+        if (!stream_thread_ && updater_thread_ && (depth_stream_.enabled() || infrared_stream_.enabled()))
+            stream_thread_.reset(new std::thread(&KinectWrapper::streamUpdater, this));
+        else SetEvent(h_streamWakeEvent);
+    }
+
+    bool initializeColorReader()
+    {
+        CComPtr<IColorFrameSource> colorFrameSource;
+        if (FAILED(kinectSensor->get_ColorFrameSource(&colorFrameSource)) || !colorFrameSource ||
+            FAILED(colorFrameSource->OpenReader(&colorFrameReader)) || !colorFrameReader)
+            return false;
+
+        colorFrameReader->SubscribeFrameArrived(&h_colorFrameEvent);
+        return true;
+    }
+
+    void terminateColorReader()
+    {
+        if (!colorFrameReader) return;
+        colorFrameReader->UnsubscribeFrameArrived(h_colorFrameEvent);
+        colorFrameReader->Release();
+
+        h_colorFrameEvent = NULL;
+        colorFrameReader = nullptr;
+    }
+
+    // Counted as a pool writer throughout, so start_replay knows when the pool is its own
+    void processColorFrame(IColorFrame* colorFrame)
+    {
+        color_writers_++;
+        writeColorFrame(colorFrame);
+        color_writers_--;
+    }
+
+    void writeColorFrame(IColorFrame* colorFrame)
+    {
+        const auto arrival = qpc_now();
+        const auto published = color_frames_.sequence();
 
-                // Get hand states
-                i->get_HandLeftState(&leftHandState);
-                i->get_HandRightState(&rightHandState);
+        // The converter thread still owns the frame pool, or a replay does
+        if (raw_color_pending_ || replaying_)
+        {
+            stats_.color_frame(arrival, false);
+            return;
+        }
+
+        // Adaptive mode: skipped on purpose, to keep the body pipeline in budget
+        if (!color_throttle_.admit(arrival, color_throttle_settings_.load(), stats_)) return;
+
+        // Hand the raw frame off, so conversion doesn't delay body frames
+        if (raw_color_conversion() && queueRawColorFrame(colorFrame, arrival)) return;
 
-                break; // Enough
+        if (preview_scale() == 1)
+        {
+            // Convert into a free pool slot, drop the frame if readers hold them all
+            if (const auto buffer = color_frames_.begin_write(ColorFrameBufferSize()))
+            {
+                KINECT_TRACE_ZONE("CopyConvertedFrameDataToArray");
+                if (SUCCEEDED(colorFrame->CopyConvertedFrameDataToArray(
+                    ColorFrameBufferSize(), buffer, ColorImageFormat_Bgra)))
+                    commitFullColorFrame(buffer);
+                else
+                    color_frames_.cancel_write();
             }
+        }
+        else
+        {
+            // Convert the full frame once, then scale it into the pool
+            if (!color_staging_) color_staging_.reset(new BYTE[ColorFrameBufferSize()]);
 
-            skeleton_tracked_ = false;
-            leftHandState = HandState_Unknown;
-            rightHandState = HandState_Unknown;
+            KINECT_TRACE_ZONE("CopyConvertedFrameDataToArray");
+            if (SUCCEEDED(colorFrame->CopyConvertedFrameDataToArray(
+                ColorFrameBufferSize(), color_staging_.get(), ColorImageFormat_Bgra)))
+                publishColorPreview(color_staging_.get());
         }
 
-        // Don't process color if not requested
-        if (!camera_enabled()) return;
+        stats_.color_frame(arrival, color_frames_.sequence() != published);
+        if (color_frames_.sequence() != published) exportColorFrame();
+    }
 
-        // Get the color frame and process it
-        IColorFrameReference* colorFrameReference = nullptr;
-        multiFrame->get_ColorFrameReference(&colorFrameReference);
+    template <typename Callback>
+    void withExport(Callback&& callback)
+    {
+        export_users_++;
+        if (const auto shared = export_.load()) callback(*shared);
+        export_users_--;
+    }
 
-        IColorFrame* colorFrame = nullptr;
-        colorFrameReference->AcquireFrame(&colorFrame);
+    // Same writer as the pool: whoever just published the newest preview
+    void exportColorFrame()
+    {
+        withExport([this](SharedExport& shared)
+        {
+            if (!shared.color()) return;
 
-        if (!colorFrame) return;
-        ResetBuffer(CameraBufferSize()); // Allocate buffer for image for copy
+            const auto frame = color_frames_.acquire();
+            const auto& [width, height] = PreviewFrameSize(frame.size());
+            if (frame && frame.size() >= static_cast<size_t>(width) * height * 4)
+                shared.publish_color(frame.data(), width, height,
+                                     preview_factor_, preview_origin_x_, preview_origin_y_);
+        });
+    }
+
+    // Copy the raw YUY2 frame for the converter thread, false if it's not YUY2
+    bool queueRawColorFrame(IColorFrame* colorFrame, const int64_t arrival)
+    {
+        ColorImageFormat format = ColorImageFormat_None;
+        if (FAILED(colorFrame->get_RawColorImageFormat(&format)) ||
+            format != ColorImageFormat_Yuy2) return false; // Let the SDK handle it
+
+        const auto& [width, height] = ColorFrameSize();
+        const auto rawSize = static_cast<UINT>(width * height * 2);
+
+        UINT size = 0;
+        BYTE* raw = nullptr;
+        if (FAILED(colorFrame->AccessRawUnderlyingBuffer(&size, &raw)) || !raw || size < rawSize)
+            return false;
+
+        if (!color_raw_) color_raw_.reset(new BYTE[rawSize]);
+        std::memcpy(color_raw_.get(), raw, rawSize);
+
+        // Start the converter on first use
+        if (!converter_thread_) converter_thread_.reset(new std::thread(&KinectWrapper::converter, this));
+
+        color_raw_arrival_ = arrival;
+        raw_color_pending_ = true;
+        SetEvent(h_colorConvertEvent);
+        return true;
+    }
 
-        colorFrame->CopyConvertedFrameDataToArray(
-            CameraBufferSize(), color_buffer_, ColorImageFormat_Bgra);
+    void converter()
+    {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL); // Color never beats poses
+        HANDLE handles[] = {h_shutdownEvent, h_colorConvertEvent};
+        while (WaitForMultipleObjects(_countof(handles), handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1)
+        {
+            if (!raw_color_pending_) continue;
+
+            const auto published = color_frames_.sequence();
+            tryCef([&, this] { convertRawColorFrame(); });
+            stats_.color_frame(color_raw_arrival_, color_frames_.sequence() != published);
+            if (color_frames_.sequence() != published) exportColorFrame();
+
+            raw_color_pending_ = false; // Give the pool back
+        }
+    }
+
+    void convertRawColorFrame()
+    {
+        KINECT_TRACE_ZONE("convertRawColorFrame");
+        const auto& [width, height] = ColorFrameSize();
+        if (preview_scale() == 1)
+        {
+            const auto buffer = color_frames_.begin_write(ColorFrameBufferSize());
+            if (!buffer) return; // All slots are leased, drop this one
 
-        if (colorFrame) colorFrame->Release();
+            convert_yuy2_to_bgra(color_raw_.get(), width, height, buffer);
+            commitFullColorFrame(buffer);
+        }
+        else
+        {
+            if (!color_staging_) color_staging_.reset(new BYTE[ColorFrameBufferSize()]);
+            convert_yuy2_to_bgra(color_raw_.get(), width, height, color_staging_.get());
+            publishColorPreview(color_staging_.get());
+        }
     }
 
+    // Opens the sensor without waiting for it, availability is reported by updateStatus()
     bool initKinect()
     {
         // Get a working Kinect Sensor
-        if (FAILED(GetDefaultKinectSensor(&kinectSensor))) return false;
-        if (kinectSensor)
+        if (FAILED(GetDefaultKinectSensor(&kinectSensor)) || !kinectSensor) return false;
+
+        // Subscribe first, so the change to available can't be missed
+        kinectSensor->SubscribeIsAvailableChanged(&h_statusChangedEvent);
+        kinectSensor->get_CoordinateMapper(&coordMapper);
+
+        if (FAILED(kinectSensor->Open()))
         {
-            kinectSensor->get_CoordinateMapper(&coordMapper);
-            HRESULT hr_open = kinectSensor->Open();
+            kinectSensor->UnsubscribeIsAvailableChanged(h_statusChangedEvent);
+            if (coordMapper) coordMapper->Release();
+            kinectSensor->Release();
+
+            h_statusChangedEvent = NULL;
+            coordMapper = nullptr;
+            kinectSensor = nullptr;
+            return false;
+        }
 
-            // Necessary to allow kinect to become available behind the scenes
-            std::this_thread::sleep_for(std::chrono::seconds(2));
+        return true;
+    }
 
-            BOOLEAN available = false;
-            kinectSensor->get_IsAvailable(&available);
+    // The sensor's unique id (this process's, before there is one), safe for an object name
+    std::wstring exportInstanceId()
+    {
+        WCHAR id[256] = {};
+        std::wstring instance = kinectSensor && SUCCEEDED(kinectSensor->get_UniqueKinectId(ARRAYSIZE(id), id)) && id[0]
+                                    ? id
+                                    : L"pid" + std::to_wstring(GetCurrentProcessId());
+
+        // Backslashes would be read as a namespace
+        for (auto& c : instance)
+            if (!std::iswalnum(c)) c = L'_';
+        return instance;
+    }
 
-#ifdef _DEBUG
-            // Emulation support bypass
-            available = true;
-#endif
+    bool onUpdaterThread() const
+    {
+        return updater_thread_ && updater_thread_->get_id() == std::this_thread::get_id();
+    }
 
-            // Check the sensor (just in case)
-            if (FAILED(hr_open) || !available || kinectSensor == nullptr)
-            {
-                return false;
-            }
+    // Called back on the updater: stop taking frames now, the rest once the callback has returned
+    void deferShutdown()
+    {
+        std::lock_guard lock(shutdown_lock_);
+        if (shutdown_thread_) return; // Already on its way
+
+        SetEvent(h_shutdownEvent);
+        shutdown_thread_.reset(new std::thread([this] { shutdownNow(); }));
+    }
 
-            // Register a StatusChanged event
-            h_statusChangedEvent = (WAITABLE_HANDLE)CreateEvent(nullptr, FALSE, FALSE, nullptr);
-            kinectSensor->SubscribeIsAvailableChanged(&h_statusChangedEvent);
+    bool workersRunning()
+    {
+        return updater_thread_ || color_thread_ || converter_thread_ || stream_thread_ || shutdownDeferred();
+    }
 
-            return true;
+    bool shutdownDeferred()
+    {
+        std::lock_guard lock(shutdown_lock_);
+        return shutdown_thread_ != nullptr;
+    }
+
+    // Anything the updater asked for is finished before the sensor is touched again
+    void joinDeferredShutdown()
+    {
+        std::unique_ptr<std::thread> thread;
+        {
+            std::lock_guard lock(shutdown_lock_);
+            thread.swap(shutdown_thread_);
         }
 
-        return false;
+        if (thread && thread->joinable()) thread->join();
     }
 
     void initializeFrameReader()
     {
+        if (split_readers_)
+        {
+            // Body frames get their own reader, color is opened on demand
+            if (bodyFrameReader)
+                bodyFrameReader->Release();
+
+            CComPtr<IBodyFrameSource> bodyFrameSource;
+            kinectSensor->get_BodyFrameSource(&bodyFrameSource);
+            bodyFrameSource->OpenReader(&bodyFrameReader);
+            bodyFrameReader->SubscribeFrameArrived(&h_bodyFrameEvent);
+
+            if (!color_thread_)
+                color_thread_.reset(new std::thread(&KinectWrapper::colorUpdater, this));
+            return;
+        }
+
         if (multiFrameReader)
             multiFrameReader->Release();
 
         kinectSensor->OpenMultiSourceFrameReader(
             FrameSourceTypes_Body | FrameSourceTypes_Color, &multiFrameReader);
 
-        // Newfangled event based frame capture
+        // Newfangled event based frame capture, the reader hands out (and owns) the handle
         // https://github.com/StevenHickson/PCL_Kinect2SDK/blob/master/src/Microsoft_grabber2.cpp
-        h_multiFrameEvent = (WAITABLE_HANDLE)CreateEvent(nullptr, FALSE, FALSE, nullptr);
         multiFrameReader->SubscribeMultiSourceFrameArrived(&h_multiFrameEvent);
     }
 
     void terminateMultiFrame()
     {
+        if (bodyFrameReader)
+        {
+            bodyFrameReader->UnsubscribeFrameArrived(h_bodyFrameEvent);
+            bodyFrameReader->Release();
+
+            h_bodyFrameEvent = NULL;
+            bodyFrameReader = nullptr;
+        }
+
         if (!multiFrameReader)return; // No need to do anything
         if (FAILED(multiFrameReader->UnsubscribeMultiSourceFrameArrived(h_multiFrameEvent)))
         {
@@ -179,7 +897,6 @@ class KinectWrapper
         }
         __try
         {
-            CloseHandle((HANDLE)h_multiFrameEvent);
             multiFrameReader->Release();
         }
         __except (EXCEPTION_EXECUTE_HANDLER)
@@ -233,36 +950,54 @@ class KinectWrapper
         JointManual
     };
 
-    std::map<JointType, _JointType> KinectJointTypeDictionary
-    {
-        {JointHead, JointType_Head},
-        {JointNeck, JointType_Neck},
-        {JointSpineShoulder, JointType_SpineShoulder},
-        {JointShoulderLeft, JointType_ShoulderLeft},
-        {JointElbowLeft, JointType_ElbowLeft},
-        {JointWristLeft, JointType_WristLeft},
-        {JointHandLeft, JointType_HandLeft},
-        {JointHandTipLeft, JointType_HandTipLeft},
-        {JointThumbLeft, JointType_ThumbLeft},
-        {JointShoulderRight, JointType_ShoulderRight},
-        {JointElbowRight, JointType_ElbowRight},
-        {JointWristRight, JointType_WristRight},
-        {JointHandRight, JointType_HandRight},
-        {JointHandTipRight, JointType_HandTipRight},
-        {JointThumbRight, JointType_ThumbRight},
-        {JointSpineMiddle, JointType_SpineMid},
-        {JointSpineWaist, JointType_SpineBase},
-        {JointHipLeft, JointType_HipLeft},
-        {JointKneeLeft, JointType_KneeLeft},
-        {JointFootLeft, JointType_AnkleLeft},
-        {JointFootTipLeft, JointType_FootLeft},
-        {JointHipRight, JointType_HipRight},
-        {JointKneeRight, JointType_KneeRight},
-        {JointFootRight, JointType_AnkleRight},
-        {JointFootTipRight, JointType_FootRight},
+    // Amethyst joint (TrackedJointType order) -> Kinect joint, resolved at compile time
+    static constexpr std::array<_JointType, JointManual> KinectJointTypes
+    {
+        JointType_Head, // JointHead
+        JointType_Neck, // JointNeck
+        JointType_SpineShoulder, // JointSpineShoulder
+        JointType_ShoulderLeft, // JointShoulderLeft
+        JointType_ElbowLeft, // JointElbowLeft
+        JointType_WristLeft, // JointWristLeft
+        JointType_HandLeft, // JointHandLeft
+        JointType_HandTipLeft, // JointHandTipLeft
+        JointType_ThumbLeft, // JointThumbLeft
+        JointType_ShoulderRight, // JointShoulderRight
+        JointType_ElbowRight, // JointElbowRight
+        JointType_WristRight, // JointWristRight
+        JointType_HandRight, // JointHandRight
+        JointType_HandTipRight, // JointHandTipRight
+        JointType_ThumbRight, // JointThumbRight
+        JointType_SpineMid, // JointSpineMiddle
+        JointType_SpineBase, // JointSpineWaist
+        JointType_HipLeft, // JointHipLeft
+        JointType_KneeLeft, // JointKneeLeft
+        JointType_AnkleLeft, // JointFootLeft
+        JointType_FootLeft, // JointFootTipLeft
+        JointType_HipRight, // JointHipRight
+        JointType_KneeRight, // JointKneeRight
+        JointType_AnkleRight, // JointFootRight
+        JointType_FootRight, // JointFootTipRight
     };
 
+    template <typename T, size_t... I>
+    static constexpr std::array<T, sizeof...(I)> gather_joints(
+        const std::array<T, JointType_Count>& source, std::index_sequence<I...>)
+    {
+        return {source[KinectJointTypes[I]]...};
+    }
+
 public:
+    ~KinectWrapper()
+    {
+        joinDeferredShutdown();
+        stopThreads();
+        stop_export();
+        for (const auto handle : {h_shutdownEvent, h_wakeEvent, h_colorWakeEvent, h_colorConvertEvent,
+                                  h_streamWakeEvent, h_replayClosedEvent})
+            if (handle) CloseHandle(handle);
+    }
+
     bool is_initialized()
     {
 #ifdef _DEBUG
@@ -286,19 +1021,55 @@ public:
 #endif
     }
 
+    // Returns at once: the sensor and its readers are opened on the first call and kept,
+    // frames start flowing whenever the sensor reports it's available
     int initialize()
     {
         try
         {
-            initialized_ = initKinect();
-            if (!is_initialized()) return 1;
+            // The updater is on its way out, it's not coming back from its own callback
+            if (onUpdaterThread())
+            {
+                if (shutdownDeferred()) return 1;
+            }
+            else joinDeferredShutdown();
+
+            if (!kinectSensor && !initKinect()) return 1;
+
+            // A reader mode change needs fresh readers, with nobody using the old ones
+            // (Called back from the updater, it's left for the next initialize call)
+            if (split_readers_ != split_readers_requested_ &&
+                (multiFrameReader || bodyFrameReader) && !onUpdaterThread())
+            {
+                stopThreads();
+                terminateMultiFrame();
+            }
+
+            if (!multiFrameReader && !bodyFrameReader)
+            {
+                split_readers_ = split_readers_requested_;
+                initializeFrameReader();
+            }
+
+            BOOLEAN available = false;
+            kinectSensor->get_IsAvailable(&available);
+
+#ifdef _DEBUG
+            // Emulation support bypass
+            available = true;
+#endif
 
-            initializeFrameReader();
+            initialized_ = available;
+            connection_.opening(available);
 
-            // Recreate the updater thread
+            // Recreate the updater thread, or make it pick up the new handles
+            ResetEvent(h_shutdownEvent);
             if (!updater_thread_)
                 updater_thread_.reset(new std::thread(&KinectWrapper::updater, this));
+            else
+                SetEvent(h_wakeEvent);
 
+            startStreamThread();
             return 0; // OK
         }
         catch (...)
@@ -307,73 +1078,98 @@ public:
         }
     }
 
-    void update()
+    // Sleeps until there's a frame, a status change or a shutdown request
+    // Returns false once the updater should exit
+    bool update()
     {
-        // Update availability
-        tryCef([&, this]
-        {
-            if (kinectSensor)
-            {
-                CComPtr<IIsAvailableChangedEventArgs> args;
-                if (kinectSensor->GetIsAvailableChangedEventData(h_statusChangedEvent, &args) == S_OK)
-                {
-                    BOOLEAN isAvailable = false;
-                    args->get_IsAvailable(&isAvailable);
+        if (replay_stop_.exchange(false)) closeReplay();
 
-#ifdef _DEBUG
-                    // Emulation support bypass
-                    isAvailable = true;
-#endif
+        HANDLE handles[4] = {h_shutdownEvent, h_wakeEvent};
+        DWORD count = 2, statusIndex = MAXDWORD, frameIndex = MAXDWORD;
 
-                    initialized_ = isAvailable; // Update the status
-                    status_changed_event(); // Notify the CLR listener
-                }
-            }
-        });
+        if (kinectSensor && h_statusChangedEvent)
+        {
+            statusIndex = count;
+            handles[count++] = reinterpret_cast<HANDLE>(h_statusChangedEvent);
+        }
 
-        // Update (only if the sensor is on and its status is ok)
-        if (is_initialized() && kinectSensor)
+        // Sensor frames are left alone while a capture is replayed instead
+        const auto replaying = replaying_.load(std::memory_order_acquire);
+        if (const auto frameEvent = split_readers_ ? h_bodyFrameEvent : h_multiFrameEvent; frameEvent && !replaying)
         {
-            BOOLEAN isAvailable = false;
-            HRESULT kinectStatus = kinectSensor->get_IsAvailable(&isAvailable);
+            frameIndex = count;
+            handles[count++] = reinterpret_cast<HANDLE>(frameEvent);
+        }
 
-#ifdef _DEBUG
-            // Emulation support bypass
-            isAvailable = true;
-#endif
+        const auto timeout = replaying ? replayTimeout() : kinectSensor ? connection_.timeout(qpc_now()) : INFINITE;
+        const auto result = WaitForMultipleObjects(count, handles, FALSE, timeout);
+        if (result == WAIT_OBJECT_0) return false; // Shutting down
 
-            if (kinectStatus == S_OK)
-            {
-                // NEW ARRIVED FRAMES ------------------------
-                MSG msg;
-                while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) // Unnecessary?
-                    DispatchMessage(&msg);
-
-                if (h_multiFrameEvent)
-                    if (HANDLE handles[] = {reinterpret_cast<HANDLE>(h_multiFrameEvent)};
-                        // Wait for a frame to arrive, give up after >3s of nothing
-                        MsgWaitForMultipleObjects(_countof(handles), handles,
-                                                  false, 100, QS_ALLINPUT) == WAIT_OBJECT_0)
-                    {
-                        IMultiSourceFrameArrivedEventArgs* pArgs = nullptr;
-                        if (multiFrameReader &&
-                            SUCCEEDED(multiFrameReader->GetMultiSourceFrameArrivedEventData(h_multiFrameEvent, &pArgs)))
-                        {
-                            [&,this](IMultiSourceFrameReader& sender, IMultiSourceFrameArrivedEventArgs& eventArgs)
-                            {
-                                updateFrameData(&eventArgs);
-                            }(*multiFrameReader, *pArgs);
-                            pArgs->Release(); // Release the frame
-                        }
-                    }
-            }
+        if (result == WAIT_TIMEOUT)
+        {
+            if (replaying) replayFrames();
+            else checkConnection();
+            return true;
         }
+
+        if (result == WAIT_FAILED)
+        {
+            // A handle was swapped under us, back off and re-read them
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return true;
+        }
+
+        KINECT_TRACE_ZONE("update"); // The wakeup, not the wait
+
+        const auto index = result - WAIT_OBJECT_0;
+        if (index == statusIndex) updateStatus();
+        else if (index == frameIndex && is_initialized()) updateFrame();
+
+        return true; // The wake event only makes us re-read the handles
     }
 
+    // From the updater's own callbacks this only starts the shutdown, it finishes on another thread
     int shutdown()
+    {
+        if (onUpdaterThread())
+        {
+            deferShutdown();
+            return 0;
+        }
+
+        joinDeferredShutdown();
+        return shutdownNow();
+    }
+
+    // Deletes the wrapper, on a pool thread when called back from its own updater,
+    // or when the caller may not wait for live workers (a finalizer); that one shuts down first
+    static void destroy(KinectWrapper* wrapper, const bool noWait = false)
+    {
+        if (!wrapper) return;
+        if (!wrapper->onUpdaterThread() && !(noWait && wrapper->workersRunning()))
+        {
+            delete wrapper;
+            return;
+        }
+
+        // Left allocated if even that fails, freeing it under the running updater is worse
+        TrySubmitThreadpoolCallback([](PTP_CALLBACK_INSTANCE, void* context)
+        {
+            const auto wrapper = static_cast<KinectWrapper*>(context);
+            wrapper->shutdown();
+            delete wrapper;
+        }, wrapper, nullptr);
+    }
+
+private:
+    int shutdownNow()
     {
         try
         {
+            // Stop and join all worker threads first, nothing may use the readers
+            stopThreads();
+            recorder_.stop();
+
             // Shut down the sensor (Only NUI API)
             if (kinectSensor)
             {
@@ -385,6 +1181,13 @@ public:
                     __try
                     {
                         initialized_ = false;
+                        connection_.closed();
+
+                        kinectSensor->UnsubscribeIsAvailableChanged(h_statusChangedEvent);
+                        h_statusChangedEvent = NULL;
+
+                        if (coordMapper) coordMapper->Release();
+                        coordMapper = nullptr;
 
                         kinectSensor->Close();
                         kinectSensor->Release();
@@ -406,6 +1209,7 @@ public:
         }
     }
 
+public:
     void tryCef(const std::function<void()>& callback)
     {
         try
@@ -426,29 +1230,425 @@ public:
         }
     }
 
+    SkeletonSnapshot skeleton_snapshot() const
+    {
+        return skeleton_snapshot_.load();
+    }
+
+    // Every tracked body of the latest frame, the snapshot follows one of them
+    BodyFrame body_frame() const
+    {
+        return body_frame_.load();
+    }
+
+    void body_selection(const BodySelection selection)
+    {
+        body_selection_ = selection;
+    }
+
+    BodySelection body_selection() const
+    {
+        return body_selection_;
+    }
+
+    // The TrackingId to follow in BodySelection::Manual
+    void selected_body_id(const UINT64 trackingId)
+    {
+        manual_body_id_ = trackingId;
+    }
+
+    UINT64 selected_body_id() const
+    {
+        return manual_body_id_;
+    }
+
+    // The latest frame after the joint filter (same as the raw one with no filter)
+    SkeletonSnapshot filtered_snapshot() const
+    {
+        return filtered_snapshot_.load();
+    }
+
+    // Counters and timings since startup, cheap enough to poll often
+    FrameStatsSnapshot frame_stats() const
+    {
+        return stats_.snapshot();
+    }
+
+    // Push mode, the callback runs on the updater thread and delays the next frame while it does
+    void body_frame_callback(void (*callback)())
+    {
+        body_frame_callback_.store(callback, std::memory_order_release);
+    }
+
+    bool body_frame_callback() const
+    {
+        return body_frame_callback_.load(std::memory_order_relaxed) != nullptr;
+    }
+
+    // Picked up by the updater on its next wakeup
+    void updater_thread_settings(const ThreadSettings& settings)
+    {
+        thread_settings_.store(settings);
+        thread_settings_version_++;
+        SetEvent(h_wakeEvent);
+    }
+
+    ThreadSettings updater_thread_settings() const
+    {
+        return thread_settings_.load();
+    }
+
+    // What the updater actually runs with
+    ThreadSchedule updater_schedule() const
+    {
+        return updater_schedule_.load();
+    }
+
+    // Set before initialize(), cleared before the callback's owner goes away
+    void status_changed(void (*callback)())
+    {
+        status_changed_ = callback;
+    }
+
+    ConnectionState connection_state() const
+    {
+        return connection_.state();
+    }
+
+    ConnectionStats connection_stats() const
+    {
+        return connection_.stats();
+    }
+
+    // Body frames and rate-capped color previews to <path> and <path>.idx
+    bool start_recording(const std::wstring& path, const bool withColor)
+    {
+        if (!withColor) return recorder_.start(path);
+        return recorder_.start(path, [this](const uint64_t newer_than, recording::ColorRecord& info)
+        {
+            auto frame = color_frames_.acquire(newer_than);
+            const auto& [width, height] = PreviewFrameSize(frame.size());
+            info = {width, height, preview_factor_, preview_origin_x_, preview_origin_y_};
+            return frame;
+        });
+    }
+
+    void stop_recording()
+    {
+        recorder_.stop();
+    }
+
+    bool recording() const
+    {
+        return recorder_.recording();
+    }
+
+    uint64_t recording_dropped() const
+    {
+        return recorder_.dropped();
+    }
+
+    // Publishes every body frame (and optionally the preview) to a named shared-memory ring
+    // Other processes read it with SharedExportReader, without opening the sensor
+    // The mapping is <name>.<sensor id>, see export_name(); fails if that's already taken
+    bool start_export(const std::wstring& name, const bool withColor)
+    {
+        stop_export();
+
+        const auto fullName = name + L"." + exportInstanceId();
+        auto shared = std::make_unique<SharedExport>();
+        if (!shared->open(fullName, withColor)) return false;
+
+        export_name_ = fullName;
+        export_ = shared.release();
+        return true;
+    }
+
+    // Name of the mapping readers should open, empty while not exporting
+    std::wstring export_name() const
+    {
+        return exporting() ? export_name_ : std::wstring();
+    }
+
+    void stop_export()
+    {
+        const auto shared = export_.exchange(nullptr);
+        while (export_users_) std::this_thread::yield(); // Someone's still publishing into it
+        delete shared;
+    }
+
+    bool exporting() const
+    {
+        return export_.load() != nullptr;
+    }
+
+    // Plays a capture through the pipeline instead of the sensor, works without one too
+    bool start_replay(const std::wstring& path, const bool realtime)
+    {
+        // Same as initialize(): the updater isn't coming back once it's asked to shut down
+        if (onUpdaterThread())
+        {
+            if (shutdownDeferred()) return false;
+        }
+        else joinDeferredShutdown();
+
+        if (!stop_replay() || !replay_.open(path) || replay_.count() == 0)
+        {
+            if (!replaying_) replay_.close();
+            return false;
+        }
+
+        replay_realtime_ = realtime;
+        replay_start_ = qpc_now();
+        replaying_ = true;
+
+        // Sensor color writers check replaying_ once they're counted in, the pool is the replay's
+        // when none are left (The converter is covered by raw_color_pending_, which replay checks)
+        // Stuck in the SDK for a whole second, bodies replay without color rather than share the pool
+        const auto deadline = qpc_now() + seconds_to_qpc(1.0);
+        while (color_writers_ && qpc_now() < deadline) std::this_thread::yield();
+        replay_color_ = color_writers_ == 0;
+
+        ResetEvent(h_shutdownEvent);
+        if (!updater_thread_)
+            updater_thread_.reset(new std::thread(&KinectWrapper::updater, this));
+        else
+            SetEvent(h_wakeEvent);
+
+        return true;
+    }
+
+    // The updater owns the replay, have it close the files and wait for that
+    // False if it didn't within a few seconds (blocked, or on its way out), the replay may still run
+    bool stop_replay()
+    {
+        if (!replaying_) return true;
+        if (updater_thread_ && !onUpdaterThread())
+        {
+            ResetEvent(h_replayClosedEvent);
+            if (!replaying_) return true; // Closed in between
+            replay_stop_ = true;
+            SetEvent(h_wakeEvent);
+            return WaitForSingleObject(h_replayClosedEvent, 3000) == WAIT_OBJECT_0 || !replaying_;
+        }
+
+        closeReplay();
+        return true;
+    }
+
+    bool replaying() const
+    {
+        return replaying_;
+    }
+
+    // Called by consumers with each followed snapshot they hand out, for the latency histogram
+    // Only the first pickup of a body frame counts, re-reads (e.g. predictions) say nothing about its age
+    void mark_consumed(const SkeletonSnapshot& snapshot)
+    {
+        if (!snapshot.sequence ||
+            consumed_sequence_.exchange(snapshot.sequence, std::memory_order_relaxed) == snapshot.sequence) return;
+        stats_.consumer_read(snapshot.arrival);
+    }
+
+    // Held poses and how often each gesture fired, updated once per body frame
+    GestureState gesture_state() const
+    {
+        return gesture_state_.load();
+    }
+
+    // Picked up with the next body frame
+    void joint_filter_settings(const JointFilterSettings& settings)
+    {
+        filter_settings_.store(settings);
+    }
+
+    JointFilterSettings joint_filter_settings() const
+    {
+        return filter_settings_.load();
+    }
+
+    // The latest frame extrapolated to a QPC timestamp, plus the prediction horizon
+    // Returns the plain latest frame while prediction is disabled
+    SkeletonSnapshot predicted_snapshot(const int64_t target)
+    {
+        if (!prediction_enabled()) return skeleton_snapshot();
+
+        const auto& model = prediction_model_.load();
+        const auto horizon = prediction_horizon();
+
+        // Never extrapolate further than ~3 body frames past the horizon
+        const auto seconds = static_cast<float>(qpc_to_seconds(target - model.base.arrival)) + horizon;
+        return extrapolate(model, std::clamp(seconds, 0.0f, horizon + 0.1f));
+    }
+
+    void prediction_enabled(const bool enabled)
+    {
+        prediction_enabled_ = enabled;
+    }
+
+    bool prediction_enabled()
+    {
+        return prediction_enabled_;
+    }
+
+    // Inferred joints of the followed user are kept at their learned bone lengths
+    void bone_solver_enabled(const bool enabled)
+    {
+        bone_solver_enabled_ = enabled;
+    }
+
+    bool bone_solver_enabled()
+    {
+        return bone_solver_enabled_;
+    }
+
+    // False for joints without a derived orientation (only ankles, feet, wrists and hands have one)
+    bool joint_orientation_mode(const _JointType joint, const JointOrientationMode mode)
+    {
+        if (!OrientationFixups::supported(joint)) return mode == JointOrientationMode::Sensor;
+
+        const auto bit = 1u << joint;
+        if (mode == JointOrientationMode::Derived) derived_orientations_.fetch_or(bit);
+        else derived_orientations_.fetch_and(~bit);
+        return true;
+    }
+
+    JointOrientationMode joint_orientation_mode(const _JointType joint)
+    {
+        return derived_orientations_.load() & 1u << joint
+                   ? JointOrientationMode::Derived
+                   : JointOrientationMode::Sensor;
+    }
+
+    // Extra look-ahead in seconds, to hide the sensor pipeline latency
+    void prediction_horizon(const float seconds)
+    {
+        prediction_horizon_ = std::max(seconds, 0.0f);
+    }
+
+    float prediction_horizon()
+    {
+        return prediction_horizon_;
+    }
+
     std::array<JointOrientation, JointType_Count> bone_orientations()
     {
-        return bone_orientations_;
+        return skeleton_snapshot().orientations;
     }
 
     std::array<Joint, JointType_Count> skeleton_positions()
     {
-        return skeleton_positions_;
+        return skeleton_snapshot().joints;
+    }
+
+    // Lease the latest camera frame, empty if there's none newer than the given one
+    FramePool<3>::Lease color_frame(const uint64_t newer_than = 0)
+    {
+        auto frame = color_frames_.acquire(newer_than);
+        if (frame) color_throttle_.read(frame.sequence());
+        return frame;
+    }
+
+    // Monotonic counters of delivered frames, compare against the last seen value
+    uint64_t color_frame_count() const
+    {
+        return color_frames_.sequence();
+    }
+
+    uint64_t body_frame_count() const
+    {
+        return body_frame_count_.load(std::memory_order_acquire);
+    }
+
+    // Copies the latest frame straight into a caller-owned buffer
+    // Previews stepped down by the color throttle are doubled back up to CameraImageSize
+    bool copy_color_buffer(BYTE* destination, const unsigned long size, uint64_t* sequence = nullptr)
+    {
+        const auto frame = color_frame(sequence ? *sequence : 0);
+        if (destination && frame && frame.size() * 4 == size)
+        {
+            const auto& [width, height] = PreviewFrameSize(frame.size());
+            upscale_bgra_double(frame.data(), width, height, destination);
+            if (sequence) *sequence = frame.sequence();
+            return true;
+        }
+
+        return copyFrame(frame, destination, size, sequence);
+    }
+
+    // Depth (mm) and infrared frames, only captured while enabled
+    void depth_enabled(const bool enabled)
+    {
+        depth_stream_.enabled(enabled);
+        startStreamThread();
+    }
+
+    bool depth_enabled() const
+    {
+        return depth_stream_.enabled();
     }
 
-    std::tuple<BYTE*, int> color_buffer()
+    void infrared_enabled(const bool enabled)
     {
-        return std::make_tuple(color_buffer_, size_in_bytes_last_);
+        infrared_stream_.enabled(enabled);
+        startStreamThread();
+    }
+
+    bool infrared_enabled() const
+    {
+        return infrared_stream_.enabled();
+    }
+
+    FramePool<3>::Lease depth_frame(const uint64_t newer_than = 0)
+    {
+        return depth_stream_.frame(newer_than);
+    }
+
+    FramePool<3>::Lease infrared_frame(const uint64_t newer_than = 0)
+    {
+        return infrared_stream_.frame(newer_than);
+    }
+
+    uint64_t depth_frame_count() const
+    {
+        return depth_stream_.frame_count();
+    }
+
+    uint64_t infrared_frame_count() const
+    {
+        return infrared_stream_.frame_count();
+    }
+
+    bool copy_depth_buffer(BYTE* destination, const unsigned long size, uint64_t* sequence = nullptr)
+    {
+        return copyFrame(depth_frame(sequence ? *sequence : 0), destination, size, sequence);
+    }
+
+    bool copy_infrared_buffer(BYTE* destination, const unsigned long size, uint64_t* sequence = nullptr)
+    {
+        return copyFrame(infrared_frame(sequence ? *sequence : 0), destination, size, sequence);
     }
 
     bool skeleton_tracked()
     {
-        return skeleton_tracked_;
+        return skeleton_snapshot().tracked;
+    }
+
+    // Separate body and color readers, applied on the next initialize()
+    void split_readers(const bool enabled)
+    {
+        split_readers_requested_ = enabled;
+    }
+
+    bool split_readers()
+    {
+        return split_readers_requested_;
     }
 
     void camera_enabled(bool enabled)
     {
         rgb_stream_enabled_ = enabled;
+        SetEvent(h_colorWakeEvent); // Open or close the color reader
     }
 
     bool camera_enabled(void)
@@ -456,68 +1656,359 @@ public:
         return rgb_stream_enabled_;
     }
 
-    int KinectJointType(int kinectJointType)
+    static constexpr int KinectJointType(const int kinectJointType)
+    {
+        return KinectJointTypes[kinectJointType];
+    }
+
+    // Reorder per-Kinect-joint data into Amethyst joint order, unrolled at compile time
+    template <typename T>
+    static constexpr std::array<T, JointManual> gather_joints(const std::array<T, JointType_Count>& source)
     {
-        return KinectJointTypeDictionary.at(static_cast<JointType>(kinectJointType));
+        return gather_joints(source, std::make_index_sequence<JointManual>{});
     }
 
     bool left_hand_state()
     {
-        return kinectSensor && leftHandState == HandState_Closed;
+        return kinectSensor && skeleton_snapshot().left_hand_state == HandState_Closed;
     }
 
     bool right_hand_state()
     {
-        return kinectSensor && rightHandState == HandState_Closed;
+        return kinectSensor && skeleton_snapshot().right_hand_state == HandState_Closed;
     }
 
-    std::pair<int, int> CameraImageSize()
+    enum class PreviewMode
+    {
+        Full,
+        Half,
+        Quarter
+    };
+
+    void preview_mode(const PreviewMode mode)
+    {
+        preview_scale_ = mode == PreviewMode::Quarter ? 4 : mode == PreviewMode::Half ? 2 : 1;
+    }
+
+    PreviewMode preview_mode()
+    {
+        switch (preview_scale_)
+        {
+        case 4: return PreviewMode::Quarter;
+        case 2: return PreviewMode::Half;
+        default: return PreviewMode::Full;
+        }
+    }
+
+    // Crop the preview to a half-size window around the tracked body
+    // (Only applies to scaled previews, the output size stays the same)
+    void preview_cropped(const bool cropped)
+    {
+        preview_cropped_ = cropped;
+    }
+
+    bool preview_cropped()
+    {
+        return preview_cropped_;
+    }
+
+    // Convert raw YUY2 frames ourselves, off the updater thread
+    void raw_color_conversion(const bool enabled)
+    {
+        raw_color_conversion_ = enabled;
+    }
+
+    bool raw_color_conversion()
+    {
+        return raw_color_conversion_;
+    }
+
+    // The preview mode's, halved once more while the color throttle steps down (up to 4)
+    int preview_scale()
+    {
+        return std::min(preview_scale_ * color_throttle_.scale(), 4);
+    }
+
+    std::pair<int, int> ColorFrameSize()
     {
         return std::make_pair(1920, 1080);
     }
 
-    unsigned long CameraBufferSize()
+    std::pair<int, int> DepthFrameSize()
     {
-        const auto& [width, height] = CameraImageSize();
+        return std::make_pair(512, 424); // Same for infrared
+    }
+
+    unsigned long DepthFrameBufferSize()
+    {
+        return 512 * 424 * sizeof(UINT16);
+    }
+
+    unsigned long ColorFrameBufferSize()
+    {
+        const auto& [width, height] = ColorFrameSize();
         return width * height * 4;
     }
 
-    std::pair<int, int> MapCoordinate(const CameraSpacePoint& skeletonPoint)
+    // Size of the preview image handed out to readers, fixed by the preview mode
+    // (The pool may hold smaller frames while the color throttle steps down, see copy_color_buffer)
+    std::pair<int, int> CameraImageSize()
+    {
+        if (replaying_ && replay_image_size_.first > 0) return replay_image_size_;
+
+        const auto& [width, height] = ColorFrameSize();
+        return std::make_pair(width / preview_scale_, height / preview_scale_);
+    }
+
+    // Size of a pooled preview, which may predate a change of the preview scale
+    std::pair<int, int> PreviewFrameSize(const size_t size)
     {
-        auto _skeletonPoint = skeletonPoint;
-        if (_skeletonPoint.Z < 0) _skeletonPoint.Z = 0.1f;
+        if (replaying_) return CameraImageSize();
 
-        ColorSpacePoint spacePoint; // Holds the mapped coordinate
-        const auto& result = coordMapper->MapCameraPointToColorSpace(_skeletonPoint, &spacePoint);
+        const auto& [width, height] = ColorFrameSize();
+        for (const auto scale : {1, 2, 4})
+            if (size == static_cast<size_t>(width / scale) * (height / scale) * 4)
+                return std::make_pair(width / scale, height / scale);
 
-        return SUCCEEDED(result) && !std::isnan(spacePoint.X) && !std::isnan(spacePoint.Y)
-                   ? std::make_pair(spacePoint.X, spacePoint.Y) // Send the mapped ones
-                   : std::make_pair(-1, -1); // Unknown coordinates - fall back to default drawing
+        return CameraImageSize();
     }
 
-private:
-    DWORD size_in_bytes_ = 0;
-    DWORD size_in_bytes_last_ = 0;
-    BYTE* color_buffer_ = nullptr;
+    unsigned long CameraBufferSize()
+    {
+        const auto& [width, height] = CameraImageSize();
+        return width * height * 4;
+    }
+
+    std::pair<int, int> MapCoordinate(const CameraSpacePoint& skeletonPoint)
+    {
+        std::pair<int, int> coordinate;
+        map_coordinates(&skeletonPoint, 1, &coordinate.first);
+        return coordinate;
+    }
 
-    BYTE* ResetBuffer(UINT size)
+    // Maps any number of points with one mapper call per chunk, into x/y pairs
+    void map_coordinates(const CameraSpacePoint* points, const size_t count, int* coordinates)
     {
-        size_in_bytes_last_ = size;
-        if (!color_buffer_ || size_in_bytes_ != size)
+        constexpr size_t ChunkSize = 64; // Stays on the stack
+        std::array<CameraSpacePoint, ChunkSize> chunk;
+        std::array<ColorSpacePoint, ChunkSize> mapped;
+
+        for (size_t offset = 0; offset < count; offset += ChunkSize)
         {
-            if (color_buffer_)
+            const auto size = std::min(ChunkSize, count - offset);
+            for (size_t i = 0; i < size; i++)
             {
-                delete[] color_buffer_;
-                color_buffer_ = nullptr;
+                chunk[i] = points[offset + i];
+                if (chunk[i].Z < 0) chunk[i].Z = 0.1f;
             }
 
-            if (0 != size)
+            if (!coordMapper || FAILED(coordMapper->MapCameraPointsToColorSpace(
+                static_cast<UINT>(size), chunk.data(), static_cast<UINT>(size), mapped.data())))
+                std::fill_n(mapped.begin(), size, ColorSpacePoint{-INFINITY, -INFINITY});
+
+            for (size_t i = 0; i < size; i++)
             {
-                color_buffer_ = new BYTE[size];
+                const auto& [x, y] = preview_coordinate(mapped[i]);
+                coordinates[(offset + i) * 2] = x;
+                coordinates[(offset + i) * 2 + 1] = y;
             }
-            size_in_bytes_ = size;
+        }
+    }
+
+    // Color space -> preview image space (scaled and/or cropped), -1 if unknown
+    std::pair<int, int> preview_coordinate(const ColorSpacePoint& spacePoint)
+    {
+        if (!std::isfinite(spacePoint.X) || !std::isfinite(spacePoint.Y))
+            return std::make_pair(-1, -1); // Unknown coordinates - fall back to default drawing
+
+        // Stepped-down frames reach readers doubled, so their pixels cover half as much
+        const auto factor = static_cast<float>(preview_factor_) / preview_upscale_;
+        return std::make_pair(
+            static_cast<int>((spacePoint.X - preview_origin_x_) / factor),
+            static_cast<int>((spacePoint.Y - preview_origin_y_) / factor));
+    }
+
+    // Map every joint on the updater thread, read back through color_points
+    void joint_mapping_enabled(const bool enabled)
+    {
+        joint_mapping_enabled_ = enabled;
+    }
+
+    bool joint_mapping_enabled() const
+    {
+        return joint_mapping_enabled_;
+    }
+
+    // Cap, shrink or pause the color pipeline from body timings and reader demand
+    // (The preview size follows, readers should check CameraImageSize on every frame)
+    void color_throttle_settings(const ColorThrottleSettings& settings)
+    {
+        color_throttle_settings_.store(settings);
+    }
+
+    ColorThrottleSettings color_throttle_settings() const
+    {
+        return color_throttle_settings_.load();
+    }
+
+    ColorThrottleStats color_throttle_stats() const
+    {
+        return color_throttle_.stats();
+    }
+
+    // Rasterize the skeleton into every preview frame, so readers only blit the image
+    void overlay_enabled(const bool enabled)
+    {
+        overlay_enabled_ = enabled;
+    }
+
+    bool overlay_enabled() const
+    {
+        return overlay_enabled_;
+    }
+
+private:
+    static bool copyFrame(const FramePool<3>::Lease& frame, BYTE* destination,
+                          const unsigned long size, uint64_t* sequence)
+    {
+        if (!destination || !frame || size < frame.size()) return false;
+
+        std::memcpy(destination, frame.data(), frame.size());
+        if (sequence) *sequence = frame.sequence();
+        return true;
+    }
+
+    std::atomic<bool> joint_mapping_enabled_{false};
+    std::atomic<bool> overlay_enabled_{false};
+
+    std::atomic<int> preview_scale_{1};
+
+    // Adaptive frame rate and size, decided on the color path
+    ColorThrottle color_throttle_;
+    SeqLocked<ColorThrottleSettings> color_throttle_settings_;
+    std::atomic<bool> preview_cropped_{false};
+
+    // Region of the last published preview, in color space
+    std::atomic<int> preview_factor_{1};
+    std::atomic<int> preview_upscale_{1}; // 2 while the pool holds stepped-down frames
+    std::atomic<int> preview_origin_x_{0};
+    std::atomic<int> preview_origin_y_{0};
+
+    std::unique_ptr<BYTE[]> color_staging_;
+    std::unique_ptr<BYTE[]> color_scratch_;
+
+    // Raw YUY2 handoff to the converter thread, which owns the pool while pending
+    std::atomic<bool> raw_color_conversion_{false};
+    std::atomic<bool> raw_color_pending_{false};
+    std::atomic<int> color_writers_{0}; // Inside processColorFrame, checked against replaying_
+    std::unique_ptr<BYTE[]> color_raw_;
+    int64_t color_raw_arrival_ = 0; // QPC, handed over with the raw frame
+    std::unique_ptr<std::thread> converter_thread_;
+    HANDLE h_colorConvertEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    // Draws the followed (filtered) skeleton into a preview about to be published
+    // Uses the joints mapped with their body frame if there are any, one batched mapping otherwise
+    void drawOverlay(BYTE* buffer, const int width, const int height,
+                     const int factor, const int originX, const int originY)
+    {
+        if (!overlay_enabled_.load(std::memory_order_relaxed)) return;
+
+        const auto snapshot = filtered_snapshot_.load();
+        if (!snapshot.tracked) return;
+
+        KINECT_TRACE_ZONE("drawOverlay");
+        auto colorPoints = snapshot.color_points;
+        if (!joint_mapping_enabled())
+        {
+            std::array<CameraSpacePoint, JointType_Count> points;
+            for (size_t i = 0; i < JointType_Count; i++) points[i] = snapshot.joints[i].Position;
+
+            if (!coordMapper || FAILED(coordMapper->MapCameraPointsToColorSpace(
+                static_cast<UINT>(points.size()), points.data(),
+                static_cast<UINT>(colorPoints.size()), colorPoints.data())))
+                return;
+        }
+
+        OverlayJoints joints;
+        for (size_t i = 0; i < JointType_Count; i++)
+        {
+            joints.x[i] = (colorPoints[i].X - originX) / factor;
+            joints.y[i] = (colorPoints[i].Y - originY) / factor;
+            joints.states[i] = snapshot.joints[i].TrackingState;
+        }
+
+        draw_skeleton_overlay(buffer, width, height, static_cast<size_t>(width) * 4, joints);
+    }
+
+    // Where to center the cropped preview: the body, or the frame's middle
+    std::pair<int, int> previewCropCenter()
+    {
+        const auto& [width, height] = ColorFrameSize();
+        const auto& snapshot = skeleton_snapshot(); // May run on the converter thread
+        if (!snapshot.tracked || !coordMapper)
+            return std::make_pair(width / 2, height / 2);
+
+        ColorSpacePoint spacePoint{};
+        if (FAILED(coordMapper->MapCameraPointToColorSpace(
+                snapshot.joints[JointType_SpineMid].Position, &spacePoint)) ||
+            std::isnan(spacePoint.X) || std::isnan(spacePoint.Y))
+            return std::make_pair(width / 2, height / 2);
+
+        return std::make_pair(static_cast<int>(spacePoint.X), static_cast<int>(spacePoint.Y));
+    }
+
+    void commitFullColorFrame(BYTE* buffer)
+    {
+        const auto& [width, height] = ColorFrameSize();
+        drawOverlay(buffer, width, height, 1, 0, 0);
+
+        preview_factor_ = 1;
+        preview_upscale_ = 1;
+        preview_origin_x_ = 0;
+        preview_origin_y_ = 0;
+        color_frames_.commit_write();
+    }
+
+    // Scale (and optionally crop) a full BGRA frame into the frame pool
+    void publishColorPreview(const BYTE* frame)
+    {
+        const auto& [width, height] = ColorFrameSize();
+        const auto scale = preview_scale();
+        const auto cropped = preview_cropped() && scale > 1;
+
+        // The whole frame, or a half-size window that gets scaled half as much
+        auto regionWidth = width, regionHeight = height;
+        auto originX = 0, originY = 0;
+        if (cropped)
+        {
+            regionWidth /= 2;
+            regionHeight /= 2;
+
+            const auto& [centerX, centerY] = previewCropCenter();
+            originX = std::clamp(centerX - regionWidth / 2, 0, width - regionWidth);
+            originY = std::clamp(centerY - regionHeight / 2, 0, height - regionHeight);
+        }
+
+        const auto factor = cropped ? scale / 2 : scale;
+        if (factor == 4 && !color_scratch_)
+            color_scratch_.reset(new BYTE[(width / 2) * (height / 2) * 4]);
+
+        const auto buffer = color_frames_.begin_write(
+            (regionWidth / factor) * (regionHeight / factor) * 4);
+        if (!buffer) return; // All slots are leased, drop this one
+
+        if (!scale_bgra(frame + originY * width * 4 + originX * 4,
+                        regionWidth, regionHeight, width * 4, factor, buffer, color_scratch_.get()))
+        {
+            color_frames_.cancel_write();
+            return;
         }
 
-        return color_buffer_;
+        drawOverlay(buffer, regionWidth / factor, regionHeight / factor, factor, originX, originY);
+        preview_factor_ = factor;
+        preview_upscale_ = (regionWidth / factor) * 2 == width / preview_scale_ ? 2 : 1;
+        preview_origin_x_ = originX;
+        preview_origin_y_ = originY;
+        color_frames_.commit_write();
     }
 };
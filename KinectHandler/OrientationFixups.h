@@ -0,0 +1,170 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <xmmintrin.h>
+
+#include "SkeletonSnapshot.h"
+
+enum class JointOrientationMode
+{
+    Sensor, // Whatever Kinect reports (zero for the foot and hand tips)
+    Derived // Look-rotation from the joint positions around it
+};
+
+// Replaces the unstable ankle, foot, wrist and hand orientations with ones built from positions
+// Same convention as Kinect: Y along the bone into the joint, Z picks the roll, X = Y x Z
+class OrientationFixups
+{
+    struct Fixup
+    {
+        JointType joint, parent; // Bone parent -> joint is Y
+        JointType reference_from, reference_to; // Roll: Z is this vector, made perpendicular to Y
+    };
+
+    // Legs roll towards the toes (feet towards the knee), arms and hands towards the thumb
+    static constexpr std::array<Fixup, 10> Fixups
+    {
+        {
+            {JointType_AnkleLeft, JointType_KneeLeft, JointType_AnkleLeft, JointType_FootLeft},
+            {JointType_FootLeft, JointType_AnkleLeft, JointType_AnkleLeft, JointType_KneeLeft},
+            {JointType_AnkleRight, JointType_KneeRight, JointType_AnkleRight, JointType_FootRight},
+            {JointType_FootRight, JointType_AnkleRight, JointType_AnkleRight, JointType_KneeRight},
+
+            {JointType_WristLeft, JointType_ElbowLeft, JointType_WristLeft, JointType_ThumbLeft},
+            {JointType_HandLeft, JointType_WristLeft, JointType_WristLeft, JointType_ThumbLeft},
+            {JointType_HandTipLeft, JointType_HandLeft, JointType_HandLeft, JointType_ThumbLeft},
+            {JointType_WristRight, JointType_ElbowRight, JointType_WristRight, JointType_ThumbRight},
+            {JointType_HandRight, JointType_WristRight, JointType_WristRight, JointType_ThumbRight},
+            {JointType_HandTipRight, JointType_HandRight, JointType_HandRight, JointType_ThumbRight}
+        }
+    };
+
+    static constexpr float MinLength = 1e-3f; // m, shorter vectors carry no direction
+
+    // Last derived orientation per joint, held while the geometry is degenerate
+    std::array<Vector4, JointType_Count> last_{};
+    uint32_t valid_ = 0; // Bit per JointType
+
+    static __m128 load(const CameraSpacePoint& point)
+    {
+        return _mm_set_ps(0.0f, point.Z, point.Y, point.X);
+    }
+
+    // Dot product of the xyz lanes, broadcast to all four
+    static __m128 dot3(const __m128 a, const __m128 b)
+    {
+        const auto product = _mm_mul_ps(a, b);
+        const auto yx = _mm_shuffle_ps(product, product, _MM_SHUFFLE(3, 0, 0, 1));
+        const auto zz = _mm_shuffle_ps(product, product, _MM_SHUFFLE(3, 2, 2, 2));
+        const auto sum = _mm_add_ss(_mm_add_ss(product, yx), zz);
+        return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+    }
+
+    static __m128 cross(const __m128 a, const __m128 b)
+    {
+        const auto aYzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        const auto bYzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        const auto c = _mm_sub_ps(_mm_mul_ps(a, bYzx), _mm_mul_ps(aYzx, b));
+        return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    // False if the vector is too short to normalize
+    static bool normalize(__m128& v)
+    {
+        const auto length = _mm_sqrt_ps(dot3(v, v));
+        if (_mm_cvtss_f32(length) < MinLength) return false;
+        v = _mm_div_ps(v, length);
+        return true;
+    }
+
+    // Rotation with the given (orthonormal) axes as its columns
+    static Vector4 quaternion(const __m128 x, const __m128 y, const __m128 z)
+    {
+        alignas(16) float m[3][4];
+        _mm_store_ps(m[0], x);
+        _mm_store_ps(m[1], y);
+        _mm_store_ps(m[2], z);
+
+        // m[column][row], Shepperd's method picks the largest term to divide by
+        const auto trace = m[0][0] + m[1][1] + m[2][2];
+        if (trace > 0)
+        {
+            const auto s = 0.5f / std::sqrt(trace + 1.0f);
+            return {(m[1][2] - m[2][1]) * s, (m[2][0] - m[0][2]) * s, (m[0][1] - m[1][0]) * s, 0.25f / s};
+        }
+        if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+        {
+            const auto s = 2.0f * std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]);
+            return {0.25f * s, (m[1][0] + m[0][1]) / s, (m[2][0] + m[0][2]) / s, (m[1][2] - m[2][1]) / s};
+        }
+        if (m[1][1] > m[2][2])
+        {
+            const auto s = 2.0f * std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]);
+            return {(m[1][0] + m[0][1]) / s, 0.25f * s, (m[2][1] + m[1][2]) / s, (m[2][0] - m[0][2]) / s};
+        }
+
+        const auto s = 2.0f * std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]);
+        return {(m[2][0] + m[0][2]) / s, (m[2][1] + m[1][2]) / s, 0.25f * s, (m[0][1] - m[1][0]) / s};
+    }
+
+    static bool derive(const std::array<Joint, JointType_Count>& joints, const Fixup& fixup, Vector4& orientation)
+    {
+        for (const auto joint : {fixup.joint, fixup.parent, fixup.reference_from, fixup.reference_to})
+            if (joints[joint].TrackingState == TrackingState_NotTracked) return false;
+
+        auto y = _mm_sub_ps(load(joints[fixup.joint].Position), load(joints[fixup.parent].Position));
+        if (!normalize(y)) return false;
+
+        // Drop the part along the bone, what's left is the roll
+        auto z = _mm_sub_ps(load(joints[fixup.reference_to].Position), load(joints[fixup.reference_from].Position));
+        z = _mm_sub_ps(z, _mm_mul_ps(y, dot3(y, z)));
+        if (!normalize(z)) return false; // Reference runs along the bone
+
+        const auto x = cross(y, z);
+        orientation = quaternion(x, y, z);
+        return true;
+    }
+
+public:
+    static constexpr bool supported(const JointType joint)
+    {
+        for (const auto& fixup : Fixups)
+            if (fixup.joint == joint) return true;
+        return false;
+    }
+
+    void reset()
+    {
+        valid_ = 0;
+    }
+
+    // Once per body frame; derived is a bit per JointType that should not keep the sensor's orientation
+    void apply(SkeletonSnapshot& snapshot, const uint32_t derived)
+    {
+        for (const auto& fixup : Fixups)
+        {
+            const auto bit = 1u << fixup.joint;
+            if (!(derived & bit)) continue;
+
+            Vector4 orientation;
+            if (derive(snapshot.joints, fixup, orientation))
+            {
+                // Stay in the hemisphere of the last frame, so filters don't flip through zero
+                auto& last = last_[fixup.joint];
+                if (valid_ & bit && orientation.x * last.x + orientation.y * last.y +
+                    orientation.z * last.z + orientation.w * last.w < 0)
+                    orientation = Vector4{-orientation.x, -orientation.y, -orientation.z, -orientation.w};
+
+                last = orientation;
+                valid_ |= bit;
+            }
+            else if (!(valid_ & bit)) continue; // Nothing to hold yet, keep the sensor's
+
+            snapshot.orientations[fixup.joint].Orientation = last_[fixup.joint];
+        }
+    }
+};
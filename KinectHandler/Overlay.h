@@ -0,0 +1,102 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include "SkeletonSnapshot.h"
+
+// Skeleton joints in preview pixels, what the overlay needs from one body frame
+struct OverlayJoints
+{
+    std::array<float, JointType_Count> x{}, y{};
+    std::array<TrackingState, JointType_Count> states{};
+};
+
+namespace overlay
+{
+    constexpr uint32_t TrackedColor = 0xFF30E040; // BGRA as a little-endian dword: green
+    constexpr uint32_t InferredColor = 0xFFF0C020; // Amber
+    constexpr uint32_t JointColor = 0xFFFFFFFF;
+
+    // Square brush, clipped to the image
+    inline void fill_square(BYTE* pixels, const int width, const int height, const size_t stride,
+                            const int x, const int y, const int radius, const uint32_t color)
+    {
+        const auto left = std::max(x - radius, 0), right = std::min(x + radius, width - 1);
+        const auto top = std::max(y - radius, 0), bottom = std::min(y + radius, height - 1);
+        if (left > right || top > bottom) return;
+
+        for (auto row = top; row <= bottom; row++)
+            std::fill_n(reinterpret_cast<uint32_t*>(pixels + row * stride) + left, right - left + 1, color);
+    }
+
+    inline void fill_circle(BYTE* pixels, const int width, const int height, const size_t stride,
+                            const int x, const int y, const int radius, const uint32_t color)
+    {
+        const auto top = std::max(y - radius, 0), bottom = std::min(y + radius, height - 1);
+        for (auto row = top; row <= bottom; row++)
+        {
+            const auto dy = row - y;
+            const auto span = static_cast<int>(std::sqrt(static_cast<float>(radius * radius - dy * dy)));
+            const auto left = std::max(x - span, 0), right = std::min(x + span, width - 1);
+            if (left <= right)
+                std::fill_n(reinterpret_cast<uint32_t*>(pixels + row * stride) + left, right - left + 1, color);
+        }
+    }
+
+    // DDA line stamped with a square brush, steps just past the visible part are skipped
+    inline void draw_line(BYTE* pixels, const int width, const int height, const size_t stride,
+                          const float x0, const float y0, const float x1, const float y1,
+                          const int radius, const uint32_t color)
+    {
+        const auto steps = static_cast<int>(std::max(std::fabs(x1 - x0), std::fabs(y1 - y0)));
+        const auto dx = steps ? (x1 - x0) / steps : 0.0f, dy = steps ? (y1 - y0) / steps : 0.0f;
+
+        auto x = x0, y = y0;
+        for (auto i = 0; i <= steps; i++, x += dx, y += dy)
+        {
+            const auto px = static_cast<int>(std::lround(x)), py = static_cast<int>(std::lround(y));
+            if (px + radius < 0 || py + radius < 0 || px - radius >= width || py - radius >= height) continue;
+            fill_square(pixels, width, height, stride, px, py, radius, color);
+        }
+    }
+
+    inline bool usable(const OverlayJoints& joints, const int joint, const int width, const int height)
+    {
+        // Anything this far out is a mapping failure, and would make for a very long line
+        return joints.states[joint] != TrackingState_NotTracked &&
+            std::isfinite(joints.x[joint]) && std::isfinite(joints.y[joint]) &&
+            std::fabs(joints.x[joint]) < width * 4.0f && std::fabs(joints.y[joint]) < height * 4.0f;
+    }
+}
+
+// Bones, then joint dots on top, straight into a BGRA image; thickness follows the image size
+inline void draw_skeleton_overlay(BYTE* pixels, const int width, const int height, const size_t stride,
+                                  const OverlayJoints& joints)
+{
+    using namespace overlay;
+    const auto line = std::max(1, width / 640);
+    const auto dot = line * 2 + 1;
+
+    for (const auto& bone : SkeletonBones)
+    {
+        if (!usable(joints, bone.parent, width, height) || !usable(joints, bone.child, width, height)) continue;
+
+        const auto inferred = joints.states[bone.parent] != TrackingState_Tracked ||
+            joints.states[bone.child] != TrackingState_Tracked;
+        draw_line(pixels, width, height, stride,
+                  joints.x[bone.parent], joints.y[bone.parent], joints.x[bone.child], joints.y[bone.child],
+                  line, inferred ? InferredColor : TrackedColor);
+    }
+
+    for (auto i = 0; i < JointType_Count; i++)
+        if (usable(joints, i, width, height))
+            fill_circle(pixels, width, height, stride,
+                        static_cast<int>(std::lround(joints.x[i])), static_cast<int>(std::lround(joints.y[i])),
+                        dot, joints.states[i] == TrackingState_Tracked ? JointColor : InferredColor);
+}
@@ -0,0 +1,464 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "BodyTracking.h"
+#include "ColorConversion.h"
+#include "FramePool.h"
+#include "Timing.h"
+
+// Capture layout: <path> holds a FileHeader and then records back to back,
+// <path>.idx one IndexEntry per record, so it can be mapped and searched as an array
+// Both are append-only, an index entry is only written after its record
+namespace recording
+{
+    constexpr uint32_t Magic = 0x4345524B; // "KREC"
+    constexpr uint32_t Version = 1;
+
+    enum class RecordType : uint32_t
+    {
+        Body = 1, // uint32 count, then count BodyRecords
+        Color = 2 // ColorRecord, then width * height BGRA pixels
+    };
+
+#pragma pack(push, 1)
+    struct FileHeader
+    {
+        uint32_t magic = Magic;
+        uint32_t version = Version;
+    };
+
+    struct RecordHeader
+    {
+        RecordType type;
+        uint32_t size; // Payload only
+        TIMESPAN timestamp; // Body frame RelativeTime, the last one for color
+    };
+
+    struct IndexEntry
+    {
+        uint64_t offset; // Of the RecordHeader in the data file
+        TIMESPAN timestamp;
+        RecordType type;
+        uint32_t size;
+    };
+
+    struct BodyRecord
+    {
+        UINT64 tracking_id;
+        Joint joints[JointType_Count];
+        JointOrientation orientations[JointType_Count];
+        HandState left_hand_state, right_hand_state;
+    };
+
+    struct ColorRecord
+    {
+        int32_t width, height;
+        int32_t factor, origin_x, origin_y; // Where it sits in the 1920x1080 color space
+    };
+#pragma pack(pop)
+}
+
+// Streams body frames (and optionally a downscaled camera feed) to disk
+// The updater only copies into a ring, a writer thread does the file I/O
+class FrameRecorder
+{
+public:
+    // Leases the latest camera frame newer than the given one, plus where it came from
+    using ColorSource = std::function<FramePool<3>::Lease(uint64_t newer_than, recording::ColorRecord& info)>;
+
+private:
+    static constexpr size_t RingSize = 32; // ~1s of body frames
+
+    struct PendingBodyFrame
+    {
+        TIMESPAN timestamp = 0;
+        BodyFrame frame;
+    };
+
+    std::unique_ptr<PendingBodyFrame[]> ring_;
+    std::atomic<size_t> head_{0}, tail_{0}; // Producer: head, writer: tail
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> recording_{false};
+
+    HANDLE data_file_ = INVALID_HANDLE_VALUE, index_file_ = INVALID_HANDLE_VALUE;
+    uint64_t offset_ = 0; // Writer only
+    TIMESPAN last_timestamp_ = 0;
+
+    ColorSource color_source_;
+    int64_t color_interval_ = 0; // QPC ticks between color records
+    int64_t last_color_ = 0;
+    uint64_t last_color_sequence_ = 0;
+    std::unique_ptr<BYTE[]> color_buffer_;
+
+    std::unique_ptr<std::thread> writer_;
+    HANDLE h_dataEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    HANDLE h_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+    bool write(const void* data, const DWORD size, const HANDLE file)
+    {
+        DWORD written = 0;
+        return WriteFile(file, data, size, &written, nullptr) && written == size;
+    }
+
+    void writeRecord(const recording::RecordType type, const TIMESPAN timestamp,
+                     const void* prefix, const uint32_t prefixSize, const void* data, const uint32_t size)
+    {
+        const recording::RecordHeader header{type, prefixSize + size, timestamp};
+        const recording::IndexEntry entry{offset_, timestamp, type, header.size};
+
+        if (!write(&header, sizeof header, data_file_) ||
+            !write(prefix, prefixSize, data_file_) ||
+            (size && !write(data, size, data_file_)))
+            return; // Disk full or similar, the index stays consistent
+
+        offset_ += sizeof header + header.size;
+        write(&entry, sizeof entry, index_file_);
+    }
+
+    void writeBodyFrame(const PendingBodyFrame& pending)
+    {
+        std::array<recording::BodyRecord, BODY_COUNT> bodies;
+        const auto count = static_cast<uint32_t>(pending.frame.count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const auto& body = pending.frame.bodies[i];
+            bodies[i].tracking_id = body.tracking_id;
+            std::memcpy(bodies[i].joints, body.joints.data(), sizeof bodies[i].joints);
+            std::memcpy(bodies[i].orientations, body.orientations.data(), sizeof bodies[i].orientations);
+            bodies[i].left_hand_state = body.left_hand_state;
+            bodies[i].right_hand_state = body.right_hand_state;
+        }
+
+        writeRecord(recording::RecordType::Body, pending.timestamp, &count, sizeof count,
+                    bodies.data(), static_cast<uint32_t>(count * sizeof(recording::BodyRecord)));
+        last_timestamp_ = pending.timestamp;
+    }
+
+    // Half the preview size, at a capped rate, keeps the file to a few MB/s
+    void writeColorFrame()
+    {
+        const auto now = qpc_now();
+        if (!color_source_ || now - last_color_ < color_interval_) return;
+
+        recording::ColorRecord info{};
+        const auto frame = color_source_(last_color_sequence_, info);
+        if (!frame || info.width < 2 || info.height < 2 ||
+            frame.size() < static_cast<size_t>(info.width) * info.height * 4) return;
+
+        const auto width = info.width / 2, height = info.height / 2;
+        const auto size = static_cast<size_t>(width) * height * 4;
+        if (!color_buffer_) color_buffer_.reset(new BYTE[1920 * 1080 * 4 / 4]); // Fits a halved full frame
+        downscale_bgra_half(frame.data(), info.width, info.height, info.width * 4, color_buffer_.get(), width * 4);
+
+        last_color_ = now;
+        last_color_sequence_ = frame.sequence();
+
+        info.width = width;
+        info.height = height;
+        info.factor *= 2;
+        writeRecord(recording::RecordType::Color, last_timestamp_, &info, sizeof info,
+                    color_buffer_.get(), static_cast<uint32_t>(size));
+    }
+
+    void drain()
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        while (tail != head_.load(std::memory_order_acquire))
+        {
+            writeBodyFrame(ring_[tail % RingSize]);
+            tail_.store(++tail, std::memory_order_release);
+        }
+    }
+
+    void writer()
+    {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+
+        HANDLE handles[] = {h_stopEvent, h_dataEvent};
+        while (WaitForMultipleObjects(_countof(handles), handles, FALSE, 10) != WAIT_OBJECT_0)
+        {
+            drain();
+            writeColorFrame();
+        }
+
+        drain(); // Whatever was queued before stopping
+    }
+
+public:
+    ~FrameRecorder()
+    {
+        stop();
+        for (const auto handle : {h_dataEvent, h_stopEvent})
+            if (handle) CloseHandle(handle);
+    }
+
+    // Color is recorded with up to the given rate, 0 for none
+    bool start(const std::wstring& path, ColorSource colorSource = nullptr, const int colorFps = 10)
+    {
+        if (recording_) return false;
+
+        data_file_ = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ,
+                                 nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        index_file_ = CreateFileW((path + L".idx").c_str(), GENERIC_WRITE, FILE_SHARE_READ,
+                                  nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        const recording::FileHeader header;
+        if (data_file_ == INVALID_HANDLE_VALUE || index_file_ == INVALID_HANDLE_VALUE ||
+            !write(&header, sizeof header, data_file_))
+        {
+            closeFiles();
+            return false;
+        }
+
+        if (!ring_) ring_.reset(new PendingBodyFrame[RingSize]);
+        head_ = tail_ = 0;
+        dropped_ = 0;
+        offset_ = sizeof header;
+        last_timestamp_ = 0;
+
+        color_source_ = colorFps > 0 ? std::move(colorSource) : nullptr;
+        color_interval_ = colorFps > 0 ? qpc_frequency() / colorFps : 0;
+        last_color_ = 0;
+        last_color_sequence_ = 0;
+
+        ResetEvent(h_stopEvent);
+        writer_.reset(new std::thread(&FrameRecorder::writer, this));
+        recording_ = true;
+        return true;
+    }
+
+    void stop()
+    {
+        if (!recording_.exchange(false)) return;
+
+        SetEvent(h_stopEvent);
+        if (writer_ && writer_->joinable()) writer_->join();
+        writer_.reset();
+
+        color_source_ = nullptr;
+        closeFiles();
+    }
+
+    bool recording() const
+    {
+        return recording_.load(std::memory_order_relaxed);
+    }
+
+    // Body frames that didn't fit in the ring since start()
+    uint64_t dropped() const
+    {
+        return dropped_;
+    }
+
+    // The updater thread: queue one frame, never blocks on disk
+    void push(const BodyFrame& frame, const TIMESPAN timestamp)
+    {
+        if (!recording()) return;
+
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= RingSize)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return; // The writer fell behind
+        }
+
+        auto& slot = ring_[head % RingSize];
+        slot.timestamp = timestamp;
+        slot.frame = frame;
+
+        head_.store(head + 1, std::memory_order_release);
+        SetEvent(h_dataEvent);
+    }
+
+private:
+    void closeFiles()
+    {
+        for (const auto file : {&data_file_, &index_file_})
+        {
+            if (*file == INVALID_HANDLE_VALUE) continue;
+            FlushFileBuffers(*file);
+            CloseHandle(*file);
+            *file = INVALID_HANDLE_VALUE;
+        }
+    }
+};
+
+// Read-only view of a capture, both files memory-mapped
+class FrameReplay
+{
+    struct MappedFile
+    {
+        HANDLE file = INVALID_HANDLE_VALUE, mapping = nullptr;
+        const BYTE* data = nullptr;
+        size_t size = 0;
+
+        bool open(const std::wstring& path)
+        {
+            file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                               nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+            LARGE_INTEGER length{};
+            if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &length) || length.QuadPart <= 0)
+                return false;
+
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) return false;
+
+            data = static_cast<const BYTE*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            size = data ? static_cast<size_t>(length.QuadPart) : 0;
+            return data != nullptr;
+        }
+
+        void close()
+        {
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+
+            *this = MappedFile{};
+        }
+    };
+
+    MappedFile data_, index_;
+    const recording::IndexEntry* entries_ = nullptr;
+    size_t count_ = 0, next_ = 0;
+
+    // Header and payload inside the data file, after its FileHeader (no overflow on bad offsets)
+    bool fits(const recording::IndexEntry& entry) const
+    {
+        constexpr auto header = sizeof(recording::RecordHeader);
+        return entry.offset >= sizeof(recording::FileHeader) && entry.offset <= data_.size &&
+            data_.size - entry.offset >= header && data_.size - entry.offset - header >= entry.size;
+    }
+
+public:
+    ~FrameReplay()
+    {
+        close();
+    }
+
+    bool open(const std::wstring& path)
+    {
+        close();
+        if (!data_.open(path) || !index_.open(path + L".idx") ||
+            data_.size < sizeof(recording::FileHeader))
+        {
+            close();
+            return false;
+        }
+
+        const auto header = reinterpret_cast<const recording::FileHeader*>(data_.data);
+        if (header->magic != recording::Magic || header->version != recording::Version)
+        {
+            close();
+            return false;
+        }
+
+        // Play up to the first entry pointing outside the data (a torn tail, or a damaged index)
+        // Every payload() is in bounds from here on
+        entries_ = reinterpret_cast<const recording::IndexEntry*>(index_.data);
+        const auto entries = index_.size / sizeof(recording::IndexEntry);
+        count_ = 0;
+        while (count_ < entries && fits(entries_[count_])) count_++;
+
+        next_ = 0;
+        return count_ > 0;
+    }
+
+    void close()
+    {
+        data_.close();
+        index_.close();
+        entries_ = nullptr;
+        count_ = next_ = 0;
+    }
+
+    bool is_open() const
+    {
+        return entries_ != nullptr;
+    }
+
+    size_t count() const
+    {
+        return count_;
+    }
+
+    // The next record to play, nullptr at the end
+    const recording::IndexEntry* peek() const
+    {
+        return next_ < count_ ? &entries_[next_] : nullptr;
+    }
+
+    void advance()
+    {
+        if (next_ < count_) next_++;
+    }
+
+    void rewind()
+    {
+        next_ = 0;
+    }
+
+    TIMESPAN first_timestamp() const
+    {
+        return count_ ? entries_[0].timestamp : 0;
+    }
+
+    const BYTE* payload(const recording::IndexEntry& entry) const
+    {
+        return data_.data + entry.offset + sizeof(recording::RecordHeader);
+    }
+
+    // Unpack a body record into a BodyFrame, false if it's malformed
+    bool read_bodies(const recording::IndexEntry& entry, BodyFrame& frame) const
+    {
+        if (entry.type != recording::RecordType::Body || entry.size < sizeof(uint32_t)) return false;
+
+        const auto data = payload(entry);
+        uint32_t count = 0;
+        std::memcpy(&count, data, sizeof count);
+        if (count > BODY_COUNT || entry.size < sizeof count + count * sizeof(recording::BodyRecord))
+            return false;
+
+        frame.count = count;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            recording::BodyRecord record;
+            std::memcpy(&record, data + sizeof count + i * sizeof record, sizeof record);
+
+            auto& body = frame.bodies[i];
+            body.tracked = true;
+            body.timestamp = entry.timestamp;
+            body.tracking_id = record.tracking_id;
+            std::memcpy(body.joints.data(), record.joints, sizeof record.joints);
+            std::memcpy(body.orientations.data(), record.orientations, sizeof record.orientations);
+            body.left_hand_state = record.left_hand_state;
+            body.right_hand_state = record.right_hand_state;
+        }
+
+        return true;
+    }
+
+    // Color record header and pixels, nullptr if it's malformed
+    const BYTE* read_color(const recording::IndexEntry& entry, recording::ColorRecord& info) const
+    {
+        if (entry.type != recording::RecordType::Color || entry.size < sizeof info) return nullptr;
+
+        std::memcpy(&info, payload(entry), sizeof info);
+        if (info.width <= 0 || info.height <= 0 || info.width > 1920 || info.height > 1080 ||
+            entry.size < sizeof info + static_cast<size_t>(info.width) * info.height * 4)
+            return nullptr;
+
+        return payload(entry) + sizeof info;
+    }
+};
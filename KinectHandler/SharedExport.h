@@ -0,0 +1,321 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "ColorConversion.h"
+#include "SkeletonSnapshot.h"
+#include "Timing.h"
+
+// Layout of the named shared-memory export, readable by any process on the machine
+// Every slot is a seqlock of its own: odd while written, re-check after copying
+namespace shared_export
+{
+    constexpr uint32_t Magic = 0x4D53324B; // "K2SM"
+    constexpr uint32_t Version = 1;
+
+    constexpr uint32_t SkeletonSlots = 8; // Readers may fall up to 8 frames behind
+    constexpr uint32_t ColorSlots = 2;
+    constexpr int32_t MaxColorWidth = 960, MaxColorHeight = 540; // Larger previews are halved
+
+    struct Header
+    {
+        uint32_t magic, version;
+        uint32_t skeleton_slots, skeleton_slot_size;
+        uint64_t skeleton_offset; // From the start of the mapping
+        uint32_t color_slots, color_slot_size; // 0 slots without color
+        uint64_t color_offset;
+        int64_t qpc_frequency; // QPC is system-wide, arrival times compare across processes
+
+        std::atomic<uint64_t> skeleton_sequence; // Body frame in the newest slot, 0 = none yet
+        std::atomic<uint64_t> color_sequence; // Color frames written so far
+    };
+
+    // The followed body of one frame, raw and filtered
+    struct Skeleton
+    {
+        uint64_t sequence; // Body frame number, slot = sequence % SkeletonSlots
+        int64_t arrival; // QPC
+        TIMESPAN timestamp; // Sensor RelativeTime
+        UINT64 tracking_id;
+        uint32_t tracked, body_count;
+        int32_t left_hand_state, right_hand_state;
+
+        Joint joints[JointType_Count];
+        JointOrientation orientations[JointType_Count];
+        Joint filtered_joints[JointType_Count];
+        JointOrientation filtered_orientations[JointType_Count];
+    };
+
+    struct SkeletonSlot
+    {
+        std::atomic<uint64_t> lock;
+        Skeleton skeleton;
+    };
+
+    // BGRA pixels follow the slot header, width * height * 4 bytes
+    struct ColorFrame
+    {
+        uint64_t sequence; // Color frame number, slot = sequence % ColorSlots
+        int32_t width, height;
+        int32_t factor, origin_x, origin_y; // Where it sits in the 1920x1080 color space
+    };
+
+    struct ColorSlot
+    {
+        std::atomic<uint64_t> lock;
+        ColorFrame frame;
+    };
+
+    constexpr size_t ColorPixelsSize = static_cast<size_t>(MaxColorWidth) * MaxColorHeight * 4;
+    constexpr size_t ColorSlotSize = (sizeof(ColorSlot) + ColorPixelsSize + 63) & ~size_t(63);
+    constexpr size_t SkeletonSlotSize = (sizeof(SkeletonSlot) + 63) & ~size_t(63);
+    constexpr size_t SkeletonOffset = (sizeof(Header) + 63) & ~size_t(63);
+    constexpr size_t ColorOffset = SkeletonOffset + SkeletonSlots * SkeletonSlotSize;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Slots are shared across processes");
+
+    inline bool copy_slot(const std::atomic<uint64_t>& lock, void* destination, const void* source, const size_t size)
+    {
+        const auto before = lock.load(std::memory_order_acquire);
+        if (before & 1) return false; // Mid-write
+
+        std::memcpy(destination, source, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return lock.load(std::memory_order_relaxed) == before;
+    }
+}
+
+// Writer side, owned by the wrapper; skeletons come from the updater, color from its publisher
+class SharedExport
+{
+    HANDLE mapping_ = nullptr;
+    BYTE* view_ = nullptr;
+    shared_export::Header* header_ = nullptr;
+
+    template <typename Slot>
+    Slot* slot(const size_t offset, const size_t size, const uint64_t sequence, const uint32_t count) const
+    {
+        return reinterpret_cast<Slot*>(view_ + offset + (sequence % count) * size);
+    }
+
+    static void begin(std::atomic<uint64_t>& lock)
+    {
+        lock.store(lock.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    static void end(std::atomic<uint64_t>& lock)
+    {
+        lock.store(lock.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+public:
+    ~SharedExport()
+    {
+        close();
+    }
+
+    bool open(const std::wstring& name, const bool withColor)
+    {
+        using namespace shared_export;
+        close();
+
+        const auto size = withColor ? ColorOffset + ColorSlots * ColorSlotSize : ColorOffset;
+        mapping_ = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                      static_cast<DWORD>(size), name.c_str());
+        if (!mapping_) return false;
+
+        // Someone else's live export (or an old one still mapped by a reader), never wipe it
+        if (GetLastError() == ERROR_ALREADY_EXISTS)
+        {
+            close();
+            return false;
+        }
+
+        view_ = static_cast<BYTE*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size));
+        if (!view_)
+        {
+            close();
+            return false;
+        }
+
+        // Readers check the magic last, so fill everything else first
+        std::memset(view_, 0, size);
+        header_ = reinterpret_cast<Header*>(view_);
+        header_->version = Version;
+        header_->skeleton_slots = SkeletonSlots;
+        header_->skeleton_slot_size = static_cast<uint32_t>(SkeletonSlotSize);
+        header_->skeleton_offset = SkeletonOffset;
+        header_->color_slots = withColor ? ColorSlots : 0;
+        header_->color_slot_size = withColor ? static_cast<uint32_t>(ColorSlotSize) : 0;
+        header_->color_offset = ColorOffset;
+        header_->qpc_frequency = qpc_frequency();
+
+        std::atomic_thread_fence(std::memory_order_release);
+        header_->magic = Magic;
+        return true;
+    }
+
+    void close()
+    {
+        if (view_) UnmapViewOfFile(view_);
+        if (mapping_) CloseHandle(mapping_);
+
+        view_ = nullptr;
+        mapping_ = nullptr;
+        header_ = nullptr;
+    }
+
+    bool color() const
+    {
+        return header_ && header_->color_slots > 0;
+    }
+
+    // The updater, once per body frame
+    void publish(const SkeletonSnapshot& raw, const SkeletonSnapshot& filtered, const size_t bodyCount)
+    {
+        using namespace shared_export;
+        if (!header_) return;
+
+        const auto target = slot<SkeletonSlot>(SkeletonOffset, SkeletonSlotSize, raw.sequence, SkeletonSlots);
+        begin(target->lock);
+
+        auto& skeleton = target->skeleton;
+        skeleton.sequence = raw.sequence;
+        skeleton.arrival = raw.arrival;
+        skeleton.timestamp = raw.timestamp;
+        skeleton.tracking_id = raw.tracking_id;
+        skeleton.tracked = raw.tracked;
+        skeleton.body_count = static_cast<uint32_t>(bodyCount);
+        skeleton.left_hand_state = raw.left_hand_state;
+        skeleton.right_hand_state = raw.right_hand_state;
+
+        std::memcpy(skeleton.joints, raw.joints.data(), sizeof skeleton.joints);
+        std::memcpy(skeleton.orientations, raw.orientations.data(), sizeof skeleton.orientations);
+        std::memcpy(skeleton.filtered_joints, filtered.joints.data(), sizeof skeleton.filtered_joints);
+        std::memcpy(skeleton.filtered_orientations, filtered.orientations.data(), sizeof skeleton.filtered_orientations);
+
+        end(target->lock);
+        header_->skeleton_sequence.store(raw.sequence, std::memory_order_release);
+    }
+
+    // Whoever publishes color frames, after each new preview
+    void publish_color(const BYTE* pixels, const int width, const int height,
+                       const int factor, const int originX, const int originY)
+    {
+        using namespace shared_export;
+        if (!color() || !pixels) return;
+
+        const auto halve = width > MaxColorWidth || height > MaxColorHeight;
+        const auto outWidth = halve ? width / 2 : width, outHeight = halve ? height / 2 : height;
+        if (outWidth > MaxColorWidth || outHeight > MaxColorHeight) return; // Not a preview size
+
+        const auto sequence = header_->color_sequence.load(std::memory_order_relaxed) + 1;
+        const auto target = slot<ColorSlot>(ColorOffset, ColorSlotSize, sequence, ColorSlots);
+        const auto destination = reinterpret_cast<BYTE*>(target + 1);
+        begin(target->lock);
+
+        if (halve) downscale_bgra_half(pixels, width, height, width * 4, destination, outWidth * 4);
+        else std::memcpy(destination, pixels, static_cast<size_t>(width) * height * 4);
+
+        target->frame = {sequence, outWidth, outHeight, halve ? factor * 2 : factor, originX, originY};
+        end(target->lock);
+        header_->color_sequence.store(sequence, std::memory_order_release);
+    }
+};
+
+// Reader side, for other processes (or tools) including this header
+class SharedExportReader
+{
+    HANDLE mapping_ = nullptr;
+    const BYTE* view_ = nullptr;
+    const shared_export::Header* header_ = nullptr;
+
+public:
+    ~SharedExportReader()
+    {
+        close();
+    }
+
+    bool open(const std::wstring& name)
+    {
+        close();
+        mapping_ = OpenFileMappingW(FILE_MAP_READ, FALSE, name.c_str());
+        if (mapping_) view_ = static_cast<const BYTE*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+
+        header_ = reinterpret_cast<const shared_export::Header*>(view_);
+        if (!header_ || header_->magic != shared_export::Magic || header_->version != shared_export::Version)
+        {
+            close();
+            return false;
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+
+    void close()
+    {
+        if (view_) UnmapViewOfFile(view_);
+        if (mapping_) CloseHandle(mapping_);
+
+        view_ = nullptr;
+        mapping_ = nullptr;
+        header_ = nullptr;
+    }
+
+    uint64_t skeleton_sequence() const
+    {
+        return header_ ? header_->skeleton_sequence.load(std::memory_order_acquire) : 0;
+    }
+
+    // A given body frame (0 = the newest), false if it was overwritten or is being written
+    bool read_skeleton(shared_export::Skeleton& skeleton, uint64_t sequence = 0) const
+    {
+        using namespace shared_export;
+        if (!header_) return false;
+
+        const auto newest = skeleton_sequence();
+        if (sequence == 0) sequence = newest;
+        if (sequence == 0 || sequence > newest || newest - sequence >= header_->skeleton_slots) return false;
+
+        const auto source = reinterpret_cast<const SkeletonSlot*>(
+            view_ + header_->skeleton_offset + (sequence % header_->skeleton_slots) * header_->skeleton_slot_size);
+        return copy_slot(source->lock, &skeleton, &source->skeleton, sizeof skeleton) &&
+            skeleton.sequence == sequence;
+    }
+
+    uint64_t color_sequence() const
+    {
+        return header_ && header_->color_slots ? header_->color_sequence.load(std::memory_order_acquire) : 0;
+    }
+
+    // Copies the newest color frame into destination (MaxColorWidth * MaxColorHeight * 4 bytes)
+    bool read_color(shared_export::ColorFrame& frame, BYTE* destination) const
+    {
+        using namespace shared_export;
+        const auto sequence = color_sequence();
+        if (sequence == 0 || !destination) return false;
+
+        const auto source = reinterpret_cast<const ColorSlot*>(
+            view_ + header_->color_offset + (sequence % header_->color_slots) * header_->color_slot_size);
+
+        // Header and pixels under the same lock
+        const auto before = source->lock.load(std::memory_order_acquire);
+        if (before & 1) return false;
+
+        frame = source->frame;
+        if (frame.width <= 0 || frame.height <= 0 || frame.width > MaxColorWidth || frame.height > MaxColorHeight)
+            return false;
+
+        std::memcpy(destination, source + 1, static_cast<size_t>(frame.width) * frame.height * 4);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return source->lock.load(std::memory_order_relaxed) == before && frame.sequence == sequence;
+    }
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include <Windows.h>
+#include <Kinect.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// One self-consistent body frame, published as a whole
+struct SkeletonSnapshot
+{
+    std::array<Joint, JointType_Count> joints{};
+    std::array<JointOrientation, JointType_Count> orientations{};
+    std::array<ColorSpacePoint, JointType_Count> color_points{}; // Only with joint mapping on
+
+    HandState left_hand_state = HandState_Unknown;
+    HandState right_hand_state = HandState_Unknown;
+
+    bool tracked = false;
+    UINT64 tracking_id = 0; // Kinect TrackingId of the body, 0 if none
+    TIMESPAN timestamp = 0; // Body frame RelativeTime (100ns ticks)
+    int64_t arrival = 0; // QPC ticks when it was picked up from the sensor
+    uint64_t sequence = 0; // Monotonic body frame number, 0 = nothing yet
+};
+
+struct SkeletonBone
+{
+    JointType parent, child;
+};
+
+// Every bone of a Kinect skeleton, parents always before their children
+constexpr std::array<SkeletonBone, 24> SkeletonBones
+{
+    {
+        {JointType_SpineBase, JointType_SpineMid},
+        {JointType_SpineMid, JointType_SpineShoulder},
+        {JointType_SpineShoulder, JointType_Neck},
+        {JointType_Neck, JointType_Head},
+
+        {JointType_SpineShoulder, JointType_ShoulderLeft},
+        {JointType_ShoulderLeft, JointType_ElbowLeft},
+        {JointType_ElbowLeft, JointType_WristLeft},
+        {JointType_WristLeft, JointType_HandLeft},
+        {JointType_HandLeft, JointType_HandTipLeft},
+        {JointType_WristLeft, JointType_ThumbLeft},
+
+        {JointType_SpineShoulder, JointType_ShoulderRight},
+        {JointType_ShoulderRight, JointType_ElbowRight},
+        {JointType_ElbowRight, JointType_WristRight},
+        {JointType_WristRight, JointType_HandRight},
+        {JointType_HandRight, JointType_HandTipRight},
+        {JointType_WristRight, JointType_ThumbRight},
+
+        {JointType_SpineBase, JointType_HipLeft},
+        {JointType_HipLeft, JointType_KneeLeft},
+        {JointType_KneeLeft, JointType_AnkleLeft},
+        {JointType_AnkleLeft, JointType_FootLeft},
+
+        {JointType_SpineBase, JointType_HipRight},
+        {JointType_HipRight, JointType_KneeRight},
+        {JointType_KneeRight, JointType_AnkleRight},
+        {JointType_AnkleRight, JointType_FootRight}
+    }
+};
+
+// Single-writer seqlock, the writer never waits for readers
+// Readers retry only if they raced with a store in progress
+template <typename T>
+class SeqLocked
+{
+    std::atomic<uint64_t> sequence_{0};
+    T value_{};
+
+public:
+    void store(const T& value)
+    {
+        const auto sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed); // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+
+        value_ = value;
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    T load() const
+    {
+        T value;
+        while (true)
+        {
+            const auto before = sequence_.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                YieldProcessor(); // The writer is mid-copy, try again
+                continue;
+            }
+
+            value = value_;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequence_.load(std::memory_order_relaxed) == before)
+                return value; // Nothing was written in the meantime
+        }
+    }
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <Windows.h>
+#include <avrt.h>
+
+#include <cstdint>
+
+enum class MmcssTask
+{
+    None,
+    Games,
+    ProAudio
+};
+
+enum class SchedulePriority
+{
+    Default, // Highest with split readers, normal otherwise
+    Normal,
+    AboveNormal,
+    Highest,
+    TimeCritical
+};
+
+// How the updater thread should be scheduled, applied by the updater itself
+struct ThreadSettings
+{
+    MmcssTask mmcss_task = MmcssTask::None;
+    SchedulePriority priority = SchedulePriority::Default;
+    uint64_t affinity = 0; // Core mask, 0 = any core
+};
+
+// What the thread actually got, for the stats
+struct ThreadSchedule
+{
+    MmcssTask mmcss_task = MmcssTask::None; // None if registration failed
+    int priority = THREAD_PRIORITY_NORMAL; // Win32 value after applying
+    uint64_t affinity = 0; // 0 = any core, or the mask was rejected
+};
+
+// Applies settings to the calling thread and undoes MMCSS registration again
+// Owned by (and only touched from) the thread it schedules
+class ThreadScheduler
+{
+    HANDLE mmcss_ = nullptr;
+    MmcssTask mmcss_task_ = MmcssTask::None;
+
+    static int win32_priority(const SchedulePriority priority, const bool boostDefault)
+    {
+        switch (priority)
+        {
+        case SchedulePriority::AboveNormal: return THREAD_PRIORITY_ABOVE_NORMAL;
+        case SchedulePriority::Highest: return THREAD_PRIORITY_HIGHEST;
+        case SchedulePriority::TimeCritical: return THREAD_PRIORITY_TIME_CRITICAL;
+        case SchedulePriority::Default: return boostDefault ? THREAD_PRIORITY_HIGHEST : THREAD_PRIORITY_NORMAL;
+        default: return THREAD_PRIORITY_NORMAL;
+        }
+    }
+
+    void leaveMmcss()
+    {
+        if (mmcss_) AvRevertMmThreadCharacteristics(mmcss_);
+        mmcss_ = nullptr;
+        mmcss_task_ = MmcssTask::None;
+    }
+
+public:
+    ~ThreadScheduler()
+    {
+        leaveMmcss();
+    }
+
+    ThreadSchedule apply(const ThreadSettings& settings, const bool boostDefault)
+    {
+        const auto thread = GetCurrentThread();
+        ThreadSchedule schedule;
+
+        if (settings.mmcss_task != mmcss_task_)
+        {
+            leaveMmcss();
+            if (settings.mmcss_task != MmcssTask::None)
+            {
+                DWORD taskIndex = 0;
+                mmcss_ = AvSetMmThreadCharacteristicsW(
+                    settings.mmcss_task == MmcssTask::Games ? L"Games" : L"Pro Audio", &taskIndex);
+                if (mmcss_) mmcss_task_ = settings.mmcss_task;
+            }
+        }
+
+        // MMCSS boosts the thread on its own, the priority only picks how much
+        if (mmcss_)
+            AvSetMmThreadPriority(mmcss_, settings.priority == SchedulePriority::TimeCritical
+                                              ? AVRT_PRIORITY_CRITICAL
+                                              : AVRT_PRIORITY_HIGH);
+        else
+            SetThreadPriority(thread, win32_priority(settings.priority, boostDefault));
+
+        // An empty or foreign mask falls back to every core the process may use
+        DWORD_PTR processMask = 0, systemMask = 0;
+        GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+
+        const auto wanted = static_cast<DWORD_PTR>(settings.affinity) & processMask;
+        if (!wanted || !SetThreadAffinityMask(thread, wanted))
+            SetThreadAffinityMask(thread, processMask);
+        else
+            schedule.affinity = wanted;
+
+        schedule.mmcss_task = mmcss_task_;
+        schedule.priority = GetThreadPriority(thread);
+        return schedule;
+    }
+};
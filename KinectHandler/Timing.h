@@ -0,0 +1,33 @@
+#pragma once
+#include <Windows.h>
+
+#include <cstdint>
+
+// QueryPerformanceCounter ticks, same clock as .NET's Stopwatch.GetTimestamp()
+inline int64_t qpc_now()
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+inline int64_t qpc_frequency()
+{
+    static const auto frequency = []
+    {
+        LARGE_INTEGER value;
+        QueryPerformanceFrequency(&value);
+        return value.QuadPart;
+    }();
+    return frequency;
+}
+
+inline double qpc_to_seconds(const int64_t ticks)
+{
+    return static_cast<double>(ticks) / static_cast<double>(qpc_frequency());
+}
+
+inline int64_t seconds_to_qpc(const double seconds)
+{
+    return static_cast<int64_t>(seconds * static_cast<double>(qpc_frequency()));
+}
@@ -0,0 +1,48 @@
+// Native TraceLogging provider, see Tracing.h
+#include "Tracing.h"
+
+#ifdef KINECT_TRACING
+#include <TraceLoggingProvider.h>
+
+TRACELOGGING_DEFINE_PROVIDER(
+    kinect_trace_provider, "K2VR.KinectHandler",
+    (0x1c129ada, 0xaf8c, 0x4945, 0x81, 0x52, 0x0a, 0x3a, 0xae, 0x48, 0x09, 0x5e));
+
+namespace
+{
+    // Registered on first use, unregistered with the module
+    struct TraceRegistration
+    {
+        TraceRegistration()
+        {
+            TraceLoggingRegister(kinect_trace_provider);
+        }
+
+        ~TraceRegistration()
+        {
+            TraceLoggingUnregister(kinect_trace_provider);
+        }
+    };
+
+    void ensure_registered()
+    {
+        static TraceRegistration registration;
+    }
+}
+
+void trace_zone_begin(const char* name)
+{
+    ensure_registered();
+    TraceLoggingWrite(kinect_trace_provider, "Zone",
+                      TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                      TraceLoggingString(name, "Name"));
+}
+
+void trace_zone_end(const char* name)
+{
+    TraceLoggingWrite(kinect_trace_provider, "Zone",
+                      TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                      TraceLoggingString(name, "Name"));
+}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#include <Windows.h>
+
+// Optional ETW timeline of the pipeline, built with msbuild /p:KinectTracing=true
+// Capture the provider below in WPR/tracelog, zones show up as Start/Stop pairs in WPA
+// Provider: "K2VR.KinectHandler" {1c129ada-af8c-4945-8152-0a3aae48095e}
+
+#ifdef KINECT_TRACING
+
+// Defined in Tracing.cpp, which is compiled native
+void trace_zone_begin(const char* name);
+void trace_zone_end(const char* name);
+
+#endif
+
+// Emits a start/stop event pair around its scope, nothing without KINECT_TRACING
+class TraceZone
+{
+#ifdef KINECT_TRACING
+    const char* name_;
+
+public:
+    explicit TraceZone(const char* name) : name_(name)
+    {
+        trace_zone_begin(name_);
+    }
+
+    ~TraceZone()
+    {
+        trace_zone_end(name_);
+    }
+#else
+public:
+    explicit TraceZone(const char*)
+    {
+    }
+#endif
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+};
+
+#define KINECT_TRACE_CONCAT_(a, b) a##b
+#define KINECT_TRACE_CONCAT(a, b) KINECT_TRACE_CONCAT_(a, b)
+#define KINECT_TRACE_ZONE(name) const TraceZone KINECT_TRACE_CONCAT(traceZone, __LINE__)(name)
@@ -5,15 +5,16 @@ using System;
 using System.Collections.Generic;
 using System.Collections.ObjectModel;
 using System.ComponentModel.Composition;
+using System.Diagnostics;
 using System.Drawing;
 using System.IO;
 using System.Linq;
 using System.Numerics;
 using System.Reflection;
-using System.Runtime.InteropServices.WindowsRuntime;
 using Amethyst.Plugins.Contract;
 using Microsoft.UI.Xaml.Controls;
 using Microsoft.UI.Xaml.Media.Imaging;
+using plugin_Kinect360.PInvoke;
 
 // To learn more about WinUI, the WinUI project structure,
 // and more about our project templates, see: http://aka.ms/winui-project-info.
@@ -38,18 +39,31 @@ public class KinectOne : KinectHandler.KinectHandler, ITrackingDevice
     private bool PluginLoaded { get; set; }
     public bool IsPositionFilterBlockingEnabled => false;
     public bool IsPhysicsOverrideEnabled => false;
-    public bool IsSelfUpdateEnabled => false;
+    // Joints are pushed from the body frame callback (see OnLoad), for the plugin's whole lifetime
+    public bool IsSelfUpdateEnabled => true;
     public bool IsFlipSupported => true;
     public bool IsAppOrientationSupported => true;
     public object SettingsInterfaceRoot => null;
     public WriteableBitmap CameraImage { get; set; }
     public static IAmethystHost HostStatic { get; set; }
 
-    private readonly GestureDetector
-        _pauseDetectorLeft = new(),
-        _pauseDetectorRight = new(),
-        _pointDetectorLeft = new(),
-        _pointDetectorRight = new();
+    private IntPtr _cameraImageData;
+    private int _cameraImageSize;
+    private ulong _cameraFrame, _bodyFrame;
+    private int _jointCount; // Joints copied with the last body frame
+    private volatile bool _cameraUpdatePending;
+    private bool _previewShown = true; // Last visibility passed on to the adaptive camera
+
+    // Reused for every update, filled by the handler in one call
+    private readonly KinectHandler.KinectJointData[] _trackedJoints = new KinectHandler.KinectJointData[25];
+    private readonly Size[] _jointCoordinates = new Size[25]; // Pre-mapped with each body frame
+    private readonly Vector3[] _jointPositions = new Vector3[25]; // As handed to the host, by joint index
+
+    // Native gesture trigger counts seen so far, one per KinectGesture
+    private readonly uint[] _gestureTriggers = new uint[4];
+
+    // Host ticks and body frame callbacks may overlap while switching modes
+    private readonly object _updateLock = new();
 
     public ObservableCollection<TrackedJoint> TrackedJoints { get; } =
         // Prepend all supported joints to the joints list
@@ -118,7 +132,13 @@ public class KinectOne : KinectHandler.KinectHandler, ITrackingDevice
         HostStatic = Host;
         PluginLoaded = true;
 
+        // The preview pane is small, don't push full 1080p through it
+        PreviewMode = KinectHandler.CameraPreviewMode.Half;
+        IsBodyFrameCallbackEnabled = true; // Push joints the moment a body frame lands
+
         CameraImage = new WriteableBitmap(CameraImageWidth, CameraImageHeight);
+        _cameraImageData = IntPtr.Zero; // Re-query for the new bitmap
+        _cameraFrame = 0; // Redraw with the next frame
 
         try
         {
@@ -170,6 +190,7 @@ public class KinectOne : KinectHandler.KinectHandler, ITrackingDevice
 
     public void Shutdown()
     {
+        Host?.Log($"Kinect frame stats: {Stats}"); // Everything since startup, for diagnostics
         switch (ShutdownKinect())
         {
             case 0:
@@ -189,84 +210,89 @@ public class KinectOne : KinectHandler.KinectHandler, ITrackingDevice
 
     public void Update()
     {
-        var trackedJoints = GetTrackedKinectJoints();
-        trackedJoints.ForEach(x =>
-        {
-            TrackedJoints[trackedJoints.IndexOf(x)].TrackingState =
-                (TrackedJointState)x.TrackingState;
+        lock (_updateLock) UpdateFrame();
+    }
 
-            TrackedJoints[trackedJoints.IndexOf(x)].Position = x.Position.Safe();
-            TrackedJoints[trackedJoints.IndexOf(x)].Orientation = x.Orientation.Safe();
-        });
+    public override void BodyFrameHandler()
+    {
+        // Called on the native updater thread, the host never calls Update in self-update mode
+        // (Prediction, if enabled, is evaluated here too: extrapolated to the moment of the push)
+        if (PluginLoaded) Update();
+    }
 
-        // Update camera feed
-        if (IsCameraEnabled)
-            CameraImage.DispatcherQueue.TryEnqueue(async () =>
+    private void UpdateFrame()
+    {
+        // Update camera feed (only if there's a new frame and no pending copy)
+        if (IsCameraEnabled && !_cameraUpdatePending && ColorFrameCount != _cameraFrame)
+        {
+            _cameraUpdatePending = true;
+            CameraImage.DispatcherQueue.TryEnqueue(() =>
             {
-                var buffer = GetImageBuffer(); // Read from Kinect
-                if (buffer is null || buffer.Length <= 0) return;
-                await CameraImage.PixelBuffer.AsStream().WriteAsync(buffer);
+                _cameraUpdatePending = false;
+
+                // The adaptive camera only probes while nobody can see the preview
+                // (Checked here on the UI thread, probes keep this running while hidden)
+                var previewShown = User32.IsMainWindowShown();
+                if (previewShown != _previewShown) IsCameraPreviewVisible = _previewShown = previewShown;
+
+                if (_cameraImageData == IntPtr.Zero)
+                    _cameraImageData = CameraImage.GetPixelData(out _cameraImageSize);
+
+                // Copy from Kinect straight into the bitmap
+                if (!CopyImageBuffer(_cameraImageData, _cameraImageSize, ref _cameraFrame)) return;
                 CameraImage.Invalidate(); // Enqueue for preview refresh
             });
+        }
+
+        // Skip joints if no new body frame has arrived
+        // (Predicted joints still move between frames, so refresh those)
+        var bodyFrame = BodyFrameCount;
+        var isNewBodyFrame = bodyFrame != _bodyFrame;
+        if (isNewBodyFrame || IsPredictionEnabled)
+        {
+            _bodyFrame = bodyFrame;
 
+            // Filtered joints are the raw ones unless a native filter is selected
+            _jointCount = IsPredictionEnabled
+                ? CopyPredictedKinectJoints(_trackedJoints, Stopwatch.GetTimestamp())
+                : CopyFilteredKinectJoints(_trackedJoints);
 
-        // Update gestures
-        if (trackedJoints.Count != 25) return;
+            // Usually on the native updater thread, the host reads these under its own lock
+            lock (Host.UpdateThreadLock)
+                for (var i = 0; i < _jointCount; i++)
+                {
+                    TrackedJoints[i].TrackingState = (TrackedJointState)_trackedJoints[i].TrackingState;
+                    TrackedJoints[i].Position = _jointPositions[i] = _trackedJoints[i].Position.Safe();
+                    TrackedJoints[i].Orientation = _trackedJoints[i].Orientation.Safe();
+                }
+
+            // Refresh the preview overlay coordinates, already mapped natively
+            if (isNewBodyFrame && IsCameraEnabled && !IsPredictionEnabled)
+                CopyJointCoordinates(_jointCoordinates, true);
+        }
+
+        // Update gestures, every update like before: held inputs stay held between body frames
+        if (_jointCount != 25) return;
 
         try
         {
-            var shoulderLeft = trackedJoints[(int)TrackedJointType.JointShoulderLeft].Position;
-            var shoulderRight = trackedJoints[(int)TrackedJointType.JointShoulderRight].Position;
-            var elbowLeft = trackedJoints[(int)TrackedJointType.JointElbowLeft].Position;
-            var elbowRight = trackedJoints[(int)TrackedJointType.JointElbowRight].Position;
-            var handLeft = trackedJoints[(int)TrackedJointType.JointWristLeft].Position;
-            var handRight = trackedJoints[(int)TrackedJointType.JointWristRight].Position;
-
-            // >0.9f when elbow is not bent and the arm is straight : LEFT
-            var armDotLeft = Vector3.Dot(
-                Vector3.Normalize(elbowLeft - shoulderLeft),
-                Vector3.Normalize(handLeft - elbowLeft));
-
-            // >0.9f when the arm is pointing down : LEFT
-            var armDownDotLeft = Vector3.Dot(
-                new Vector3(0.0f, -1.0f, 0.0f),
-                Vector3.Normalize(handLeft - elbowLeft));
-
-            // >0.4f <0.6f when the arm is slightly tilted sideways : RIGHT
-            var armTiltDotLeft = Vector3.Dot(
-                Vector3.Normalize(shoulderLeft - shoulderRight),
-                Vector3.Normalize(handLeft - elbowLeft));
-
-            // >0.9f when elbow is not bent and the arm is straight : LEFT
-            var armDotRight = Vector3.Dot(
-                Vector3.Normalize(elbowRight - shoulderRight),
-                Vector3.Normalize(handRight - elbowRight));
-
-            // >0.9f when the arm is pointing down : RIGHT
-            var armDownDotRight = Vector3.Dot(
-                new Vector3(0.0f, -1.0f, 0.0f),
-                Vector3.Normalize(handRight - elbowRight));
-
-            // >0.4f <0.6f when the arm is slightly tilted sideways : RIGHT
-            var armTiltDotRight = Vector3.Dot(
-                Vector3.Normalize(shoulderRight - shoulderLeft),
-                Vector3.Normalize(handRight - elbowRight));
+            // Evaluated natively once per body frame, these only fire once per hold
+            // (A trigger is only reported by the first poll after it, then it's false again)
+            var triggered = PollTriggeredGestures(_gestureTriggers);
 
             /* Trigger the detected gestures */
 
             if (TrackedJoints[(int)TrackedJointType.JointHandLeft].SupportedInputActions.IsUsed(0, out var pauseActionLeft))
-                Host.ReceiveKeyInput(pauseActionLeft, _pauseDetectorLeft.Update(armDotLeft > 0.9f && armTiltDotLeft is > 0.4f and < 0.7f));
+                Host.ReceiveKeyInput(pauseActionLeft, Fired(triggered, KinectHandler.KinectGesture.PauseLeft));
 
             if (TrackedJoints[(int)TrackedJointType.JointHandRight].SupportedInputActions.IsUsed(0, out var pauseActionRight))
-                Host.ReceiveKeyInput(pauseActionRight, _pauseDetectorRight.Update(armDotRight > 0.9f && armTiltDotRight is > 0.4f and < 0.7f));
+                Host.ReceiveKeyInput(pauseActionRight, Fired(triggered, KinectHandler.KinectGesture.PauseRight));
 
             if (TrackedJoints[(int)TrackedJointType.JointHandLeft].SupportedInputActions.IsUsed(1, out var pointActionLeft))
-                Host.ReceiveKeyInput(pointActionLeft, _pointDetectorLeft
-                    .Update(armDotLeft > 0.9f && armTiltDotLeft is > -0.5f and < 0.5f && armDownDotLeft is > -0.3f and < 0.7f));
+                Host.ReceiveKeyInput(pointActionLeft, Fired(triggered, KinectHandler.KinectGesture.PointLeft));
 
             if (TrackedJoints[(int)TrackedJointType.JointHandRight].SupportedInputActions.IsUsed(1, out var pointActionRight))
-                Host.ReceiveKeyInput(pointActionRight, _pointDetectorRight
-                    .Update(armDotRight > 0.9f && armTiltDotRight is > -0.5f and < 0.5f && armDownDotRight is > -0.3f and < 0.7f));
+                Host.ReceiveKeyInput(pointActionRight, Fired(triggered, KinectHandler.KinectGesture.PointRight));
 
             if (TrackedJoints[(int)TrackedJointType.JointHandLeft].SupportedInputActions.IsUsed(2, out var grabActionLeft))
                 Host.ReceiveKeyInput(grabActionLeft, LeftHandClosed);
@@ -282,6 +308,13 @@ public class KinectOne : KinectHandler.KinectHandler, ITrackingDevice
         }
     }
 
+    private static bool Fired(KinectHandler.KinectGesture triggered, KinectHandler.KinectGesture gesture)
+    {
+        if (!triggered.HasFlag(gesture)) return false;
+        HostStatic?.PlayAppSound(SoundType.Focus);
+        return true;
+    }
+
     public void SignalJoint(int jointId)
     {
         // ignored
@@ -289,7 +322,7 @@ public class KinectOne : KinectHandler.KinectHandler, ITrackingDevice
 
     public override void StatusChangedHandler()
     {
-        // The Kinect sensor requested a refresh
+        // The Kinect sensor requested a refresh (cheap, the sensor and readers are kept)
         InitializeKinect();
 
         // Request a refresh of the status UI
@@ -299,7 +332,23 @@ public class KinectOne : KinectHandler.KinectHandler, ITrackingDevice
     public Func<BitmapSource> GetCameraImage => () => CameraImage;
     public Func<bool> GetIsCameraEnabled => () => IsCameraEnabled;
     public Action<bool> SetIsCameraEnabled => value => IsCameraEnabled = value;
-    public Func<Vector3, Size> MapCoordinateDelegate => MapCoordinate;
+    public Func<Vector3, Size> MapCoordinateDelegate => MapJointCoordinate;
+
+    private Size MapJointCoordinate(Vector3 position)
+    {
+        // Joints from the last update were mapped with their body frame
+        // The host passes TrackedJoints[i].Position, find i among what it was handed
+        // (Both arrays are rewritten by pushed updates, on the updater thread)
+        lock (_updateLock)
+        {
+            if (!IsPredictionEnabled && IsJointMappingEnabled)
+                for (var i = 0; i < _jointCount; i++)
+                    if (_jointPositions[i] == position)
+                        return _jointCoordinates[i];
+        }
+
+        return MapCoordinate(position); // Anything else, map on request
+    }
 }
 
 internal static class Utils
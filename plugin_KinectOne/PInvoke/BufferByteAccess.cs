@@ -0,0 +1,25 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using Microsoft.UI.Xaml.Media.Imaging;
+using WinRT;
+
+namespace plugin_Kinect360.PInvoke;
+
+[ComImport]
+[Guid("905a0fef-bc53-11df-8c49-001e4fc686da")]
+[InterfaceType(ComInterfaceType.InterfaceIsIUnknown)]
+internal interface IBufferByteAccess
+{
+    IntPtr Buffer { get; }
+}
+
+public static class BufferByteAccess
+{
+    // The pixel buffer stays put for the bitmap's lifetime, so this may be cached
+    public static IntPtr GetPixelData(this WriteableBitmap bitmap, out int size)
+    {
+        var buffer = bitmap.PixelBuffer;
+        size = (int)buffer.Capacity;
+        return buffer.As<IBufferByteAccess>().Buffer;
+    }
+}
@@ -0,0 +1,38 @@
+﻿using System;
+using System.Diagnostics;
+using System.Runtime.InteropServices;
+
+namespace plugin_Kinect360.PInvoke;
+
+public static class User32
+{
+    [DllImport("user32.dll")]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    private static extern bool IsWindow(IntPtr hWnd);
+
+    [DllImport("user32.dll")]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    private static extern bool IsWindowVisible(IntPtr hWnd);
+
+    [DllImport("user32.dll")]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    private static extern bool IsIconic(IntPtr hWnd);
+
+    private static IntPtr _mainWindow;
+    private static long _nextLookup;
+
+    // Whether the host's main window is on screen (shown and not minimized)
+    // A window that can't be found counts as shown, so nothing pauses on a guess
+    public static bool IsMainWindowShown()
+    {
+        if ((_mainWindow == IntPtr.Zero || !IsWindow(_mainWindow)) && Environment.TickCount64 >= _nextLookup)
+        {
+            using var process = Process.GetCurrentProcess();
+            _mainWindow = process.MainWindowHandle;
+            _nextLookup = Environment.TickCount64 + 1000; // The lookup isn't cheap, once a second at most
+        }
+
+        return _mainWindow == IntPtr.Zero || !IsWindow(_mainWindow) ||
+               (IsWindowVisible(_mainWindow) && !IsIconic(_mainWindow));
+    }
+}
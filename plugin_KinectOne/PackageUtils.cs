@@ -1,6 +1,4 @@
-﻿using Amethyst.Plugins.Contract;
-using System;
-using System.Diagnostics;
+﻿using System;
 using System.IO;
 using Windows.ApplicationModel;
 using Windows.Storage;
@@ -48,51 +46,3 @@ public static class StorageExtensions
             newPath.CopyTo(newPath.FullName.Replace(source.FullName, destination), true);
     }
 }
-
-public class GestureDetector
-{
-    private bool Value { get; set; }
-    private bool ValueBlock { get; set; }
-    private Stopwatch Timer { get; set; } = new();
-
-    public bool Update(bool value)
-    {
-        // ReSharper disable once ConvertIfStatementToSwitchStatement
-        if (!Value && value)
-        {
-            //Console.WriteLine("Restarting gesture timer...");
-            ValueBlock = false;
-            Timer.Restart();
-            Value = true;
-            return false;
-        }
-
-        if (!Value && !value)
-        {
-            //Console.WriteLine("Resetting gesture timer...");
-            ValueBlock = false;
-            Timer.Reset();
-            return false;
-        }
-
-        Value = value;
-
-        switch (Timer.ElapsedMilliseconds)
-        {
-            case >= 1000 when !ValueBlock:
-                //Console.Write("Gesture detected! ");
-                KinectOne.HostStatic?.PlayAppSound(SoundType.Focus);
-                ValueBlock = true;
-                return true;
-            case >= 3000 when ValueBlock:
-                //Console.Write("Restarting timer...");
-                KinectOne.HostStatic?.PlayAppSound(SoundType.Focus);
-                ValueBlock = false;
-                Timer.Restart();
-                return true;
-            default:
-                //Console.WriteLine("Gesture detected! Waiting for the timer...");
-                return false;
-        }
-    }
-}
\ No newline at end of file